@@ -7,9 +7,15 @@
 #include <atomic>
 #include <thread>
 #include <mutex>
+#include <condition_variable>
 #include <memory>
+#include <unordered_map>
 #include "MusicPlayer.hpp"
 #include "Playlist.hpp"
+#include "LibraryScanner.hpp"
+#include "LoudnessAnalyzer.hpp"
+#include "WaveformCache.hpp"
+#include "PersistenceWriter.hpp"
 
 namespace fs = std::filesystem;
 
@@ -18,6 +24,9 @@ enum class AppState {
     MAIN_MENU, 
     SETTINGS_MENU, 
     SET_MODE, 
+    SET_CROSSFADE,      // 淡入淡出时长设置
+    SET_REPLAY_GAIN,    // 响度均衡模式设置
+    SET_EQUALIZER,      // 均衡器设置
     PLAYLIST_MANAGER, 
     PLAYLIST_MENU,      // 歌单功能菜单
     PLAYLIST_CREATE, 
@@ -56,27 +65,54 @@ public:
     void decreaseVolume();
     int getVolume() const;
     int getVolumeUnlocked() const; // 不锁定的版本，用于已经在锁中的情况
+    
+    // 淡入淡出设置（0 表示关闭）
+    void setCrossfadeSeconds(int seconds);
+    int getCrossfadeSeconds() const { return player.getCrossfadeSeconds(); }
+    
+    // 响度均衡（ReplayGain / EBU R128）
+    void setReplayGainMode(ReplayGainMode mode);
+    ReplayGainMode getReplayGainMode() const { return replayGainMode; }
+    LoudnessStats getLoudnessStats() const { return loudness.getStats(); }
+
+    // 参数均衡器（预设保存在 config.json 中）
+    void setEqualizerEnabled(bool enabled);
+    bool isEqualizerEnabled() const { return eqEnabled; }
+    void selectEqualizerPreset(int index);
+    int getEqualizerPresetIndex() const { return eqPresetIndex; }
+    const std::vector<EqPreset>& getEqualizerPresets() const { return eqPresets; }
+
+    // 当前歌曲的波形概要（后台生成，尚未生成时为空）
+    std::shared_ptr<const WaveformSummary> getWaveform() const { return waveforms.current(); }
 
     // 歌单管理
     void createPlaylist(const std::string& name);
     void deletePlaylist(int index);
     void renamePlaylist(int index, const std::string& new_name);
+    // 在后台线程扫描目录并把歌曲合并到歌单；已有导入在进行时排在其后
     void addSongsFromDirectory(int playlist_index, const std::string& dir_path);
+    // 是否有目录导入正在进行或排队，以及当前导入的进度
+    bool isImporting() const { return pendingImports > 0; }
+    const ScanProgress& getImportProgress() const { return importProgress; }
     void addCurrentSongToPlaylist(int playlist_index);
     void addSongToPlaylist(int playlist_index, const std::string& song_path);
     void removeSongFromPlaylist(int playlist_index, int song_index);
     void sortPlaylist(int playlist_index, SortBy by, SortOrder order);
+    // 确保歌单内容已读入（界面打开歌单时调用；启动时后台尚未读到它则同步读取）
+    void loadPlaylistNow(int index);
     
     // 数据获取 (供UI读取)
     AppState state = AppState::PLAYING;
-    PlayMode mode = PlayMode::SEQUENTIAL;
+    std::atomic<PlayMode> mode{PlayMode::SEQUENTIAL}; // 在 dataMutex 内修改，播放线程无锁读取
     std::vector<std::shared_ptr<Playlist>> playlists;
     int currentPlaylistIndex = -1; // 当前播放的歌单索引
     int currentSongIndex = 0;      // 当前播放的歌曲索引
+    ScanStats lastScanStats;       // 最近一次目录导入的统计信息
 
     // 乱序播放相关
     std::vector<int> shuffleOrder; // 乱序索引映射：shuffleOrder[乱序索引] = 原始索引
-    bool needShuffleUpdate = false; // 需要更新乱序列表
+    std::vector<int> shufflePosition; // 逆映射：shufflePosition[原始索引] = 乱序索引
+    std::atomic<bool> needShuffleUpdate{false}; // 需要更新乱序列表
     
     // 获取乱序列表（供UI使用）
     const std::vector<int>& getShuffleOrder() const { return shuffleOrder; }
@@ -84,8 +120,8 @@ public:
     MusicPlayer& getPlayer() { return player; }
     std::mutex& getMutex() { return dataMutex; }
     bool isRunning() { return running; }
-    void stop() { running = false; }
-    void requestLoad() { needLoad = true; }
+    void stop() { running = false; wakePlaybackThread(); }
+    void requestLoad() { needLoad = true; wakePlaybackThread(); }
     
     // 获取当前播放模式
     PlayMode getPlayMode() const { return mode; }
@@ -111,24 +147,111 @@ public:
 private:
     // 生成乱序播放列表
     void generateShuffleOrder();
+    // 清空乱序列表及其逆映射
+    void clearShuffleOrder();
+    // 原始索引 -> 乱序索引（无效时返回 -1）
+    int shuffledIndexOf(int original_index) const;
 
 private:
     void loadConfig();
+    // 登记配置需要保存，由 persistence 合并后在后台写出
     void saveConfig();
+    // 当前配置（调用者需持有 dataMutex）
+    json buildConfigJson();
+    // 只读入歌单元信息，内容由 loadPlaylistBodies 在后台读取
     void loadPlaylists();
+    // 后台并行读取歌单内容和响度缓存（当前歌单优先），在 loaderThread 中运行
+    void loadPlaylistBodies();
+    // 读取第 index 个歌单文件并回放其日志；journal_bytes 返回日志中可用记录的长度，
+    // 读到的是另一种格式、日志有损坏或已超过合并阈值时 rewrite 为 true
+    bool readPlaylistFile(int index, Playlist& out, bool& rewrite, uint64_t& journal_bytes);
+    // 把读入的内容装入尚未读入的歌单，已读入或已删除时忽略；body 为空表示读取失败（调用者需持有 dataMutex）
+    void installPlaylistBody(const std::shared_ptr<Playlist>& playlist, Playlist* body, bool rewrite, uint64_t journal_bytes);
+    // 歌单内容尚未读入时在当前线程同步读取（调用者需持有 dataMutex）
+    void ensurePlaylistLoaded(int index);
+    // 登记歌单及配置元信息需要保存（调用者需持有 dataMutex）
     void savePlaylist(int index);
-    void deletePlaylistFile(int index);
-    void scanDirectoryForSongs(const std::string& dir_path, std::vector<std::string>& result);
+    // 第 index 个歌单待写出的日志记录，PlaylistJournal::record* 追加到这里（调用者需持有 dataMutex）
+    std::string& journalBuffer(int index);
+    // 登记歌单的新日志记录及配置元信息需要保存（调用者需持有 dataMutex）
+    void saveJournal(int index);
+    // 登记第 index 个歌单文件需要整体重写（同时删除其日志）
+    void markPlaylistDirty(int index);
+    // 登记第 index 个歌单文件需要与内存同步：追加日志，或日志过大时合并重写
+    void schedulePlaylistSync(int index);
+    // 删除第 index 个歌单后把其后的歌单文件（含另一种格式和日志）依次改名前移一位（调用者需持有 dataMutex）
+    void shiftPlaylistFiles(int index, int old_size);
     fs::path getConfigFilePath();
     fs::path getPlaylistsDir();
-    fs::path getPlaylistFilePath(int index);
+    // 第 index 个歌单文件（binary 为 true 时是 .smpl，否则是 .json）
+    fs::path getPlaylistFilePath(int index, bool binary);
+    // 第 index 个歌单的修改日志
+    fs::path getJournalFilePath(int index);
+    
+    // 前进到下一首并与当前歌曲交叉淡入淡出（仅播放线程调用）
+    void crossfadeNext();
+    
+    // 下一首将要播放的歌曲路径（调用者需持有 dataMutex）
+    std::string peekNextSongPath() const;
+    
+    // 让响度分析器优先分析下一首（仅播放线程调用）
+    void prioritizeNextLoudness();
+    // 所有歌单中的歌曲加入响度分析队列（调用者需持有 dataMutex 或在启动时调用）
+    void enqueueLoudnessAnalysis();
+    
+    // 把当前均衡设置交给播放器（调用者需持有 dataMutex 或在启动时调用）
+    void applyEqualizer();
+    
+    // 唤醒播放线程（状态变化或歌曲播放结束时调用）
+    void wakePlaybackThread();
+    void onTrackFinished();
+
+    // 内容尚未读入的歌单及其文件编号（受 dataMutex 保护）；删除歌单时其后的文件改名前移，
+    // fileIndex 随之减一，playlistFilesGeneration 加一，后台读取据此发现文件编号已变化
+    struct UnloadedPlaylist {
+        std::shared_ptr<Playlist> playlist;
+        int fileIndex;
+    };
+    std::vector<UnloadedPlaylist> unloadedPlaylists;
+    uint64_t playlistFilesGeneration = 0;
+    std::thread loaderThread;
+
+    // 目录导入：每个导入任务先等待上一个任务结束，importThread 始终是最后一个
+    std::thread importThread;
+    std::atomic<int> pendingImports{0};
+    ScanProgress importProgress;
+
+    // 各歌单的日志状态（受 dataMutex 保护），按歌单而不是文件位置记录，删除歌单时位置会移动
+    struct JournalState {
+        std::string pending;   // 尚未写出的记录
+        uint64_t onDisk = 0;   // 日志文件中已有的字节数
+        bool rewrite = false;  // 下次写出时整体重写歌单文件
+    };
+    std::unordered_map<const Playlist*, JournalState> journals;
+    std::atomic<bool> startupReady{false}; // 当前歌单内容和响度缓存均已读入
 
+    LoudnessAnalyzer loudness; // 需先于 player 构造、后于 player 析构
     MusicPlayer player;
+    WaveformCache waveforms;
+    std::atomic<ReplayGainMode> replayGainMode{ReplayGainMode::TRACK};
+    std::atomic<bool> needGainRefresh{false}; // 均衡模式改变，需重新计算当前歌曲增益
+    std::vector<EqPreset> eqPresets = EqPreset::builtins();
+    int eqPresetIndex = 0;
+    bool eqEnabled = false;
+    bool binaryPlaylists = false; // 歌单文件格式："json"（默认）或 "binary"
     std::atomic<bool> running{true};
     std::atomic<bool> needLoad{false};
     std::atomic<bool> isStartingUp{true}; // 是否为启动状态
+    std::atomic<bool> trackFinished{false}; // 当前歌曲已自然播放结束
+    std::atomic<bool> wakeRequested{false}; // 有状态变化，播放线程需要重新检查
+    bool prefetchDone = false;             // 当前歌曲是否已预加载下一首（仅播放线程使用）
+    bool crossfadeDone = false;            // 当前歌曲是否已开始淡出到下一首（仅播放线程使用）
+    static constexpr double kPrefetchLeadSeconds = 10.0; // 距结束多少秒时预加载
     std::thread playerThread;
+    std::mutex wakeMutex;                  // 只保护播放线程的等待条件，音频线程也会短暂持有
+    std::condition_variable playbackCv;    // 播放线程在此等待事件
     mutable std::mutex dataMutex; // 使用mutable以便在const成员函数中锁定
+    PersistenceWriter persistence; // 工作线程会锁定 dataMutex，需最先析构
 };
 
 #endif
\ No newline at end of file
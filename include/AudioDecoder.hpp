@@ -0,0 +1,57 @@
+#ifndef AUDIO_DECODER_HPP
+#define AUDIO_DECODER_HPP
+
+#include <SDL2/SDL.h>
+#include <sndfile.h>
+#include <string>
+#include <vector>
+
+// 音频解码器：用 libsndfile 解码文件，输出交错的 float PCM
+// 采样率和声道数与输出设备不同时，通过 SDL_AudioStream 转换
+class AudioDecoder {
+public:
+    AudioDecoder() = default;
+    ~AudioDecoder();
+    AudioDecoder(const AudioDecoder&) = delete;
+    AudioDecoder& operator=(const AudioDecoder&) = delete;
+
+    // 打开文件，out_rate/out_channels 为输出设备参数，传 0 表示保持文件原始格式
+    bool open(const std::string& path, int out_rate, int out_channels);
+    void close();
+    bool isOpen() const { return file != nullptr; }
+
+    // 输出设备参数改变时重新配置转换器（丢弃转换器中尚未取出的数据）
+    bool setOutput(int out_rate, int out_channels);
+
+    // 读取最多 frames 帧到 out（交错 float），返回实际读取的帧数，0 表示已结束
+    int read(float* out, int frames);
+
+    // 跳转到指定位置（秒）
+    bool seek(double seconds);
+
+    // 输出时附加的线性增益（响度均衡），1 表示不处理
+    void setGain(float value) { gain = value; }
+    float getGain() const { return gain; }
+
+    bool finished() const { return eof && !hasBufferedOutput(); }
+    int sourceRate() const { return info.samplerate; }
+    int sourceChannels() const { return info.channels; }
+    int outputRate() const { return outRate; }
+    int outputChannels() const { return outChannels; }
+    double duration() const;
+
+private:
+    int readFrames(float* out, int frames);
+    bool hasBufferedOutput() const;
+
+    SNDFILE* file = nullptr;
+    SF_INFO info{};
+    SDL_AudioStream* stream = nullptr; // 为空时表示格式一致，直接解码到输出
+    std::vector<float> scratch;        // 转换前的原始解码数据
+    int outRate = 0;
+    int outChannels = 0;
+    bool eof = false;
+    float gain = 1.0f;
+};
+
+#endif // AUDIO_DECODER_HPP
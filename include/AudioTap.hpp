@@ -0,0 +1,37 @@
+#ifndef AUDIO_TAP_HPP
+#define AUDIO_TAP_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// 输出端的 PCM 抽头：音频回调把最终输出的样本写入固定大小的循环窗口，
+// UI 线程随时读取最近的一段用于频谱和电平显示
+// 写入方永不等待、不分配内存；读取方可能读到正被覆盖的样本，对显示没有影响
+class AudioTap {
+public:
+    static constexpr size_t kFrames = 8192; // 窗口帧数（2 的幂）
+    static constexpr int kChannels = 2;     // 只保留前两个声道，单声道时复制到两侧
+
+    // 由 UI 控制：只有可视化界面显示时才写入
+    void setActive(bool on) { active.store(on, std::memory_order_relaxed); }
+    bool isActive() const { return active.load(std::memory_order_relaxed); }
+
+    // 音频回调调用：写入交错样本
+    void write(const float* data, size_t frames, int channels);
+
+    // UI 线程调用：复制最近的 frames 帧（交错双声道）到 dest，返回实际帧数
+    size_t readLatest(float* dest, size_t frames) const;
+
+    // 已写入的总帧数，用于判断是否有新数据
+    uint64_t position() const { return writePos.load(std::memory_order_acquire); }
+
+private:
+    static constexpr size_t kMask = kFrames - 1;
+
+    std::atomic<bool> active{false};
+    std::atomic<uint64_t> writePos{0};
+    std::atomic<float> samples[kFrames * kChannels] = {};
+};
+
+#endif // AUDIO_TAP_HPP
@@ -0,0 +1,54 @@
+#ifndef DSP_CHAIN_HPP
+#define DSP_CHAIN_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// DSP 处理级接口：均衡器、限幅器、声道平衡等都实现此接口
+class DspStage {
+public:
+    virtual ~DspStage() = default;
+
+    virtual const char* name() const = 0;
+
+    // 设备参数确定后调用（此时音频回调已停止）
+    virtual void prepare(int sample_rate, int channels) = 0;
+
+    // 在音频回调中原地处理交错 float 样本；不能等待锁或分配内存
+    virtual void process(float* data, size_t frames) = 0;
+
+    virtual bool isEnabled() const { return true; }
+};
+
+// 处理耗时统计
+struct DspStats {
+    double averageMicros = 0.0; // 每个缓冲区的平均耗时（微秒，指数滑动平均）
+    double peakMicros = 0.0;    // 最大耗时
+    double load = 0.0;          // 平均耗时占缓冲区时长的比例（0-1）
+};
+
+// 按顺序执行的 DSP 处理链，位于解码输出和设备输出之间
+class DspChain {
+public:
+    // 添加处理级（只能在音频设备关闭时调用）
+    void add(std::unique_ptr<DspStage> stage);
+
+    void prepare(int sample_rate, int channels);
+    void process(float* data, size_t frames);
+
+    DspStats getStats() const;
+    void resetStats();
+    size_t size() const { return stages.size(); }
+
+private:
+    std::vector<std::unique_ptr<DspStage>> stages;
+    int sampleRate = 44100;
+    int channels = 2;
+    std::atomic<double> averageMicros{0.0};
+    std::atomic<double> peakMicros{0.0};
+    std::atomic<double> load{0.0};
+};
+
+#endif // DSP_CHAIN_HPP
@@ -0,0 +1,57 @@
+#ifndef GAIN_STAGE_HPP
+#define GAIN_STAGE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <ostream>
+#include <vector>
+
+// 软件增益级：在输出前对交错 float 样本应用平滑过渡的线性增益
+// 目标增益可在任意线程设置，process 只在音频回调中调用（不加锁、不分配内存）
+// 运行时按 CPU 特性选择 AVX2/SSE/NEON 内核，均不可用时使用标量实现
+class GainStage {
+public:
+    enum class Kernel { Scalar, SSE, AVX2, NEON };
+
+    GainStage();
+
+    // 设备参数改变时调用（音频回调停止期间），重新计算过渡长度
+    void reset(int sample_rate, int channels);
+
+    // 设置目标增益，process 会在约 10ms 内线性过渡到该值，避免爆音
+    void setTarget(float gain) { targetGain.store(gain, std::memory_order_relaxed); }
+    float getTarget() const { return targetGain.load(std::memory_order_relaxed); }
+
+    // 原地处理 frames 帧
+    void process(float* data, size_t frames);
+
+    // 用最快的内核对 count 个样本乘以固定增益（可在任意线程调用）
+    static void applyConstant(float* data, size_t count, float gain);
+
+    Kernel kernel() const { return activeKernel; }
+    static const char* kernelName(Kernel kernel);
+    static std::vector<Kernel> availableKernels();
+
+    // 比较各内核的处理耗时，结果写到 out
+    static void benchmark(std::ostream& out);
+
+private:
+    // data[i] *= gain + i * step
+    using KernelFn = void (*)(float* data, size_t count, float gain, float step);
+    static KernelFn kernelFor(Kernel kernel);
+    static KernelFn bestKernel();
+
+    Kernel activeKernel = Kernel::Scalar;
+    KernelFn apply = nullptr;
+    int channels = 2;
+    size_t rampSamples = 0;        // 一次完整过渡的样本数
+    std::atomic<float> targetGain{1.0f};
+
+    // 以下仅由音频回调访问
+    float currentGain = 1.0f;
+    float rampTarget = 1.0f;
+    float rampStep = 0.0f;
+    size_t rampRemaining = 0;
+};
+
+#endif // GAIN_STAGE_HPP
@@ -0,0 +1,52 @@
+#ifndef LIBRARY_SCANNER_HPP
+#define LIBRARY_SCANNER_HPP
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <cstddef>
+#include "Playlist.hpp"
+
+// 扫描统计信息
+struct ScanStats {
+    size_t files = 0;        // 读取到的音频文件数
+    double seconds = 0.0;    // 总耗时（秒）
+    unsigned int threads = 0; // 使用的工作线程数
+
+    double filesPerSecond() const {
+        return seconds > 0.0 ? files / seconds : 0.0;
+    }
+};
+
+// 扫描进度，扫描进行中可由其他线程随时读取
+struct ScanProgress {
+    std::atomic<size_t> found{0}; // 已找到的音频文件数（目录遍历期间持续增加）
+    std::atomic<size_t> read{0};  // 已读取标签的文件数
+    std::atomic<bool> cancelled{false}; // 由其他线程设置，扫描尽快结束（结果不完整）
+};
+
+// 音乐库扫描器：递归遍历目录，并在线程池中并行读取标签
+class LibraryScanner {
+public:
+    // threads 为 0 时按 CPU 核心数自动确定
+    explicit LibraryScanner(unsigned int threads = 0);
+
+    // 递归收集目录下所有支持的音频文件（已排序）
+    static std::vector<std::string> collectAudioFiles(const std::string& dir_path, ScanProgress* progress = nullptr);
+
+    // 判断文件扩展名是否为支持的音频格式
+    static bool isSupportedAudioFile(const fs::path& path);
+
+    // 并行读取文件元数据，结果顺序与输入一致
+    std::vector<SongEntry> readMetadata(const std::vector<std::string>& paths, ScanStats* stats = nullptr,
+                                        ScanProgress* progress = nullptr);
+
+    // 递归扫描目录并读取元数据，统计的耗时包含目录遍历
+    std::vector<SongEntry> scan(const std::string& dir_path, ScanStats* stats = nullptr,
+                                ScanProgress* progress = nullptr);
+
+private:
+    unsigned int threadCount;
+};
+
+#endif // LIBRARY_SCANNER_HPP
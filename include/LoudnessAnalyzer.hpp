@@ -0,0 +1,127 @@
+#ifndef LOUDNESS_ANALYZER_HPP
+#define LOUDNESS_ANALYZER_HPP
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <cstdint>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <unordered_map>
+#include <unordered_set>
+#include <filesystem>
+#include "MetadataExtractor.hpp"
+
+namespace fs = std::filesystem;
+
+// 响度均衡模式
+enum class ReplayGainMode { OFF, TRACK, ALBUM };
+
+// 单个文件的响度信息
+struct LoudnessInfo {
+    double integrated = 0.0;   // EBU R128 综合响度（LUFS），来自标签时为 0
+    double truePeak = 0.0;     // 真峰值（线性，1.0 = 0 dBTP）
+    double trackGain = 0.0;    // 单曲增益（dB，参考电平 -18 LUFS）
+    double albumGain = 0.0;    // 专辑增益（dB）
+    double albumPeak = 0.0;    // 专辑峰值（线性）
+    bool hasAlbumGain = false; // 专辑增益是否来自标签
+    bool fromTags = false;     // 结果来自 REPLAYGAIN 标签而非分析
+    double gatedPower = 0.0;   // 通过门限的响度块平均功率（用于计算专辑响度）
+    long gatedBlocks = 0;      // 通过门限的响度块数量
+};
+
+// 分析进度统计
+struct LoudnessStats {
+    size_t processed = 0;  // 本轮已处理的文件数（含命中缓存）
+    size_t analyzed = 0;   // 其中实际解码分析的文件数
+    size_t pending = 0;    // 队列中等待的文件数
+    double seconds = 0.0;  // 本轮耗时（秒）
+    unsigned int threads = 0;
+
+    double tracksPerSecond() const {
+        return seconds > 0.0 ? processed / seconds : 0.0;
+    }
+};
+
+// 后台响度分析器：在工作线程池中按 EBU R128 计算综合响度和真峰值
+// 有 REPLAYGAIN 标签时直接使用标签；结果以 (路径, 大小, 修改时间) 为键
+// 缓存在 ~/.config/simple_music_player/loudness_cache.json
+// 所有公开接口只短暂持有内部锁，不会阻塞调用线程等待分析
+class LoudnessAnalyzer {
+public:
+    // threads 为 0 时按 CPU 核心数自动确定
+    explicit LoudnessAnalyzer(unsigned int threads = 0);
+    ~LoudnessAnalyzer();
+    LoudnessAnalyzer(const LoudnessAnalyzer&) = delete;
+    LoudnessAnalyzer& operator=(const LoudnessAnalyzer&) = delete;
+
+    // 加入分析队列（已在队列中的文件忽略）
+    void enqueue(const std::vector<std::string>& paths);
+    // 放到队首优先分析（例如即将播放的下一首）
+    void prioritize(const std::string& path);
+
+    // 查询已有结果
+    bool lookup(const std::string& path, LoudnessInfo& out);
+
+    // 计算播放时应使用的线性增益：优先使用分析/缓存结果，其次使用 meta 中的标签
+    // 都没有时返回 1 并安排优先分析；增益会受峰值限制以避免削波
+    float gainFor(const std::string& path, const TrackMetadata& meta, ReplayGainMode mode);
+
+    LoudnessStats getStats() const;
+
+    // 读入磁盘缓存（启动时由后台线程调用；读入之前分析线程不会开始工作）
+    void loadCache();
+
+    // 将修改写回磁盘（无修改时不写）
+    void save();
+
+    // 解码并分析单个文件（在调用线程中同步执行）
+    static bool measure(const std::string& path, LoudnessInfo& out);
+
+    static constexpr double kReferenceLufs = -18.0; // ReplayGain 2.0 参考电平
+
+private:
+    struct Entry {
+        std::uintmax_t size = 0;
+        std::int64_t mtime = 0;
+        std::string albumKey;  // 目录 + 专辑名
+        LoudnessInfo info;
+    };
+    struct AlbumLoudness {
+        double powerSum = 0.0; // 各曲 gatedPower * gatedBlocks 之和
+        long blocks = 0;
+        double peak = 0.0;
+    };
+
+    void startWorkers();
+    void worker();
+    void process(const std::string& path);
+    void addEntry(const std::string& path, Entry entry);   // 调用者需持有 mutex
+    void removeEntry(const std::string& path);             // 调用者需持有 mutex
+    bool albumGain(const Entry& entry, double& gain, double& peak) const; // 调用者需持有 mutex
+    static fs::path getCacheFilePath();
+
+    unsigned int threadCount;
+    std::vector<std::thread> workers;
+    mutable std::mutex mutex;
+    std::condition_variable queueCv;
+    std::deque<std::string> queue;
+    std::unordered_set<std::string> queued;
+    std::unordered_map<std::string, Entry> entries;
+    std::unordered_map<std::string, AlbumLoudness> albums;
+    bool stopping = false;
+    bool cacheLoaded = false;
+    bool dirty = false;
+    size_t busyWorkers = 0;
+
+    // 本轮统计（队列从空变为非空时开始新一轮）
+    std::chrono::steady_clock::time_point batchStart;
+    std::chrono::steady_clock::time_point batchEnd;
+    size_t batchProcessed = 0;
+    size_t batchAnalyzed = 0;
+};
+
+#endif // LOUDNESS_ANALYZER_HPP
@@ -0,0 +1,32 @@
+#ifndef LYRIC_LAYOUT_HPP
+#define LYRIC_LAYOUT_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "LyricParser.hpp"
+
+// 歌词排版缓存：按 (歌词, 显示宽度) 用 TextLayout 把每行歌词折行一次，之后每帧只做查找
+// 当前行用单调游标查找（正常播放时为 O(1)），跳转时退回二分查找
+class LyricLayout {
+public:
+    // 歌词或宽度改变时重新排版，否则什么都不做
+    void update(const Lyrics& lyrics, int width);
+
+    // 返回 ms 时刻应显示的歌词行（-1 表示第一行之前）
+    int lineAt(int64_t ms);
+
+    int lineCount() const { return (int)times.size(); }
+    int rowCount(int line) const { return (int)(firstRow[line + 1] - firstRow[line]); }
+    const std::string& row(int line, int index) const { return rows[firstRow[line] + index]; }
+
+private:
+    uint64_t lyricsId = 0;
+    int layoutWidth = -1;
+    std::vector<int64_t> times;      // 各行时间（毫秒）
+    std::vector<uint32_t> firstRow;  // 各行在 rows 中的起始位置，末尾多一个哨兵
+    std::vector<std::string> rows;   // 折行后的显示行
+    int cursor = -1;                 // 上一次查找的结果
+};
+
+#endif // LYRIC_LAYOUT_HPP
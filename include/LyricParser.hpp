@@ -0,0 +1,60 @@
+#ifndef LYRIC_PARSER_HPP
+#define LYRIC_PARSER_HPP
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// 一行歌词：时间戳和文本在 Lyrics 文本区中的位置
+// 同一行带多个时间戳时，各时间戳共享同一段文本
+struct LyricLine {
+    int64_t timeMs = 0;   // 显示时间（毫秒，已应用 [offset:]）
+    uint32_t offset = 0;  // 文本在文本区中的起始位置
+    uint32_t length = 0;  // 文本字节数
+};
+
+// 解析后的歌词：所有文本保存在一块连续内存中，按时间排序
+class Lyrics {
+public:
+    bool empty() const { return lines.empty(); }
+    size_t size() const { return lines.size(); }
+    int64_t timeMs(size_t index) const { return lines[index].timeMs; }
+    double timestamp(size_t index) const { return lines[index].timeMs / 1000.0; }
+    std::string_view text(size_t index) const {
+        return std::string_view(arena).substr(lines[index].offset, lines[index].length);
+    }
+    int64_t offsetMs() const { return offset; }
+    // 每次解析得到不同的编号（空歌词为 0），供布局缓存判断歌词是否改变
+    uint64_t id() const { return serial; }
+
+private:
+    friend class LyricParser;
+    std::string arena;
+    std::vector<LyricLine> lines;
+    int64_t offset = 0;
+    uint64_t serial = 0;
+};
+
+// LRC 解析器：单次扫描，不复制整段输入
+// 支持一行多个时间戳（[00:12.00][01:40.00]副歌）、[mm:ss]、[mm:ss.x/xx/xxx]、
+// [mm:ss:xx] 以及 [offset:±毫秒]；其他标签（ti/ar/al/by 等）忽略
+class LyricParser {
+public:
+    static Lyrics parse(std::string_view raw);
+
+    // 查找音频文件旁的同名 .lrc 文件（例如 song.flac -> song.lrc），找不到返回空字符串
+    static std::string findSidecar(const std::string& audio_path);
+    // 读取整个文件，失败时返回 false
+    static bool readFile(const std::string& path, std::string& out);
+
+    // smp --benchmark-lyrics：用生成的多语言大文件测试解析速度
+    static void benchmark(std::ostream& out);
+
+private:
+    // 解析方括号内的时间标签，成功时写入毫秒数
+    static bool parseTimeTag(std::string_view tag, int64_t& ms);
+};
+
+#endif // LYRIC_PARSER_HPP
@@ -0,0 +1,36 @@
+#ifndef METADATA_EXTRACTOR_HPP
+#define METADATA_EXTRACTOR_HPP
+
+#include <string>
+
+// 一次解析得到的音轨信息
+struct TrackMetadata {
+    std::string title;
+    std::string artist;
+    std::string album;
+    int track_number = 0;
+    int duration = 0;      // 时长（秒）
+    int sample_rate = 0;   // 采样率（Hz）
+    int channels = 0;
+    int bitrate = 0;       // 比特率（kb/s）
+    std::string lyrics;    // 内嵌歌词原文（LRC 或纯文本）
+
+    // ReplayGain 标签（增益为 dB，峰值为线性值）
+    bool has_track_gain = false;
+    bool has_album_gain = false;
+    double track_gain = 0.0;
+    double track_peak = 0.0;
+    double album_gain = 0.0;
+    double album_peak = 0.0;
+};
+
+// 统一的标签/歌词提取器：根据扩展名确定格式，每个文件只打开并解析一次
+// 支持 MP3 (ID3v2 USLT)、FLAC/Ogg Vorbis/Opus (Xiph 注释) 和 MP4 (©lyr)
+// ReplayGain 标签通过 TagLib 的统一属性表读取（ID3v2 TXXX、Xiph 注释、MP4 自由格式）
+class MetadataExtractor {
+public:
+    // 读取成功返回 true；失败时 out 保持默认值
+    static bool extract(const std::string& path, TrackMetadata& out);
+};
+
+#endif // METADATA_EXTRACTOR_HPP
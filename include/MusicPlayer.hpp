@@ -2,21 +2,56 @@
 #define MUSIC_PLAYER_HPP
 
 #include <SDL2/SDL.h>
-#include <SDL2/SDL_mixer.h>
 #include <string>
 #include <vector>
 #include <algorithm>
-
-struct LyricLine {
-    double timestamp;
-    std::string text;
-};
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "AudioDecoder.hpp"
+#include "AudioTap.hpp"
+#include "DspChain.hpp"
+#include "GainStage.hpp"
+#include "LyricParser.hpp"
+#include "MetadataExtractor.hpp"
+#include "ParametricEq.hpp"
+#include "RingBuffer.hpp"
 
 struct SongInfo {
     std::string title;
     std::string artist;
+    std::string album;
     int duration = 0;
-    std::vector<LyricLine> lyrics;
+    int sampleRate = 0;   // 原始采样率（Hz）
+    int channels = 0;
+    int bitrate = 0;      // 比特率（kb/s）
+    Lyrics lyrics;
+};
+
+// 设备输出的采样格式
+enum class SampleFormat { S16, S32, F32 };
+
+// 输出设备参数（保存在 config.json 的 audio_device 中）
+struct AudioDeviceConfig {
+    int sampleRate = 44100;                  // 0 表示自动：按歌曲原始采样率打开设备
+    SampleFormat format = SampleFormat::S16;
+    int bufferFrames = 2048;                 // 设备缓冲区帧数，越小延迟越低、CPU 占用越高
+
+    bool operator==(const AudioDeviceConfig& o) const {
+        return sampleRate == o.sampleRate && format == o.format && bufferFrames == o.bufferFrames;
+    }
+    bool operator!=(const AudioDeviceConfig& o) const { return !(*this == o); }
+};
+
+// 预先打开并解析好的歌曲，切歌时只需交换指针
+struct PreparedTrack {
+    std::string path;
+    std::unique_ptr<AudioDecoder> decoder;
+    SongInfo info;
+    TrackMetadata tags; // 标签（不含歌词），用于计算响度均衡增益
 };
 
 class MusicPlayer {
@@ -25,12 +60,15 @@ public:
     ~MusicPlayer();
 
     // 播放控制接口
-    bool load(const std::string& path);
+    bool load(const std::string& path); // 若已预加载该歌曲则直接交换
+    bool prefetch(const std::string& path); // 后台预加载下一首（与 load 在同一线程调用）
+    bool isPrefetched(const std::string& path) const { return prepared.decoder && prepared.path == path; }
+    bool crossfadeTo(const std::string& path); // 与当前歌曲交叉淡入淡出地切换到新歌曲
     void play();
     void pause();
     void resume();
     void stop();
-    
+
     // 快进快退接口
     bool seekForward(double seconds = 5.0);
     bool seekBackward(double seconds = 5.0);
@@ -42,32 +80,148 @@ public:
     double getElapsedSeconds() const;
     const SongInfo& getCurrentSong() const { return currentSong; }
     std::string getCurrentFilePath() const { return currentFilePath; }
-    
+
     // 音量控制接口
     void setVolume(int volume); // 0-100
     int getVolume() const { return currentVolume; }
-    void increaseVolume();      // 增加5%
-    void decreaseVolume();      // 减少5%
+    void increaseVolume();      // 增加2%
+    void decreaseVolume();      // 减少2%
+    static constexpr int kVolumeStep = 2;
+    const char* getGainKernelName() const { return GainStage::kernelName(gainStage.kernel()); }
+
+    // 交叉淡入淡出时长（0-12秒，0 表示直接切换）
+    void setCrossfadeSeconds(int seconds);
+    int getCrossfadeSeconds() const { return crossfadeSeconds; }
+    static constexpr int kMaxCrossfadeSeconds = 12;
+
+    // 输出设备配置：参数改变时重新打开设备，播放位置保持不变
+    bool configureDevice(const AudioDeviceConfig& config);
+    const AudioDeviceConfig& getDeviceConfig() const { return deviceConfig; }
+    int getOutputRate() const { return outRate; }
+    Uint16 getOutputFormat() const { return outFormat; }
+    int getDeviceBufferFrames() const { return latencyFrames; }
+    static const char* formatName(SampleFormat format);
+    static SampleFormat parseFormat(const std::string& name);
+    static constexpr int kMinBufferFrames = 256;
+    static constexpr int kMaxBufferFrames = 8192;
+
+    // 响度均衡：返回歌曲应使用的线性增益，在打开/切换歌曲时于控制线程调用
+    using GainResolver = std::function<float(const std::string& path, const TrackMetadata& tags)>;
+    void setGainResolver(GainResolver resolver);
+    // 重新计算当前歌曲的增益（均衡模式改变时调用）
+    void refreshTrackGain();
+    float getTrackGain() const { return trackGain; }
+
+    // DSP 处理链（位于音量增益之前）
+    ParametricEq& getEqualizer() { return *equalizer; }
+    DspStats getDspStats() const { return dspChain.getStats(); }
+
+    // 输出端 PCM 抽头（供频谱和电平显示）
+    AudioTap& getAudioTap() { return tap; }
+
+    // 歌曲自然播放结束时的回调（在解码线程中调用，只能做轻量的通知）
+    void setFinishedCallback(std::function<void()> callback);
+
+    // 输出缓冲状态
+    double getBufferedSeconds() const;   // 环形缓冲区中待播放的时长
+    // 当前歌曲尚未解码写入缓冲区的时长（按解码器的精确帧数计算）；
+    // 交叉淡变从写位置开始混合，因此切歌时机以此为准而不是播放进度
+    double getDecodeRemainingSeconds() const;
+    double getBufferFill() const;        // 缓冲区填充比例 0-1
+    double getBufferSpaceSeconds() const; // 缓冲区剩余空间的时长（解码线程最多还能超前这么多）
+    uint64_t getUnderrunCount() const { return underruns.load(std::memory_order_relaxed); }
 
 private:
-    void parseLyrics(const std::string& path);
-    double parseTime(const std::string& t);
-    std::string fetchEmbeddedLyrics(const std::string& path);
+    // SDL 音频回调：只从环形缓冲区取数据，不加锁、不分配内存
+    static void audioCallback(void* udata, Uint8* stream, int len);
+    void renderAudio(Uint8* stream, int len);
+
+    // 解码线程：解码、交叉淡变混合后写入环形缓冲区
+    void decodeLoop();
+    void decodeChunk();
+    // 设备管理（均需持有 engineMutex）
+    bool openDevice(int rate);
+    void closeDevice();
+    bool reopenDevice(int rate);
+    bool matchTrackRate();
+
+    // 通知音频回调丢弃当前已缓冲的数据，并把进度设为 frame（需持有 engineMutex）
+    void requestFlush(long long frame);
+
+    // 打开文件并解析元数据和歌词
+    bool readTrack(const std::string& path, PreparedTrack& out) const;
+    float resolveGain(const std::string& path, const TrackMetadata& tags) const;
 
-    Mix_Music* music = nullptr;
+    PreparedTrack prepared; // 预加载的下一首
     SongInfo currentSong;
+    TrackMetadata currentTags;
+    GainResolver gainResolver;
+    float trackGain = 1.0f; // 当前歌曲的响度均衡增益
     std::string currentFilePath;
-    
-    // 进度计算相关变量
-    Uint32 startTicks = 0;
-    Uint32 pauseTotalTicks = 0;
-    Uint32 pauseStartTicks = 0;
-    
+
+    // 输出设备参数（SDL_OpenAudioDevice 得到的实际值）；在 engineMutex 内修改，
+    // 界面和播放线程查询进度时无锁读取，因此用原子变量
+    AudioDeviceConfig deviceConfig;
+    SDL_AudioDeviceID device = 0;
+    std::atomic<bool> audioOpen{false};
+    std::atomic<int> outRate{44100};
+    std::atomic<int> outChannels{2};
+    Uint16 outFormat = AUDIO_S16SYS;
+    std::vector<float> outBuffer;             // 回调使用的预分配缓冲区
+
+    // 解码线程与音频回调之间的 PCM 环形缓冲区（交错 float 样本）
+    RingBuffer<float> ring;
+    std::atomic<uint64_t> underruns{0};
+
+    // 解码与混音状态，由 engineMutex 保护（解码线程和控制线程使用，音频回调不碰）
+    std::mutex engineMutex;
+    std::condition_variable decodeCv;
+    std::thread decodeThread;
+    bool decodeRunning = false;
+    std::unique_ptr<AudioDecoder> decoder;    // 当前歌曲
+    std::unique_ptr<AudioDecoder> fadingOut;  // 正在淡出的上一首（解码完毕后提前释放）
+    long fadePosition = 0;                    // 已完成的淡变帧数
+    long fadeLength = 0;                      // 淡变总帧数，fadePosition < fadeLength 时淡变进行中
+    std::vector<float> mixBuffer;             // 预分配的混音缓冲区
+    std::vector<float> fadeBuffer;
+    uint64_t endPosition = 0;                 // 当前歌曲最后一个样本在环形缓冲区中的位置
+    std::atomic<bool> streamEnded{false};     // 当前歌曲已全部解码写入缓冲区
+    std::atomic<bool> playing{false};
+    std::atomic<bool> paused{false};
+
+    // 由控制线程发布、音频回调消费的位置标记
+    static constexpr uint64_t kNoMark = ~0ull;
+    std::atomic<uint64_t> flushMark{kNoMark}; // 丢弃该位置之前的数据
+    std::atomic<long long> flushFrame{0};     // 丢弃后的进度（帧）
+    std::atomic<uint64_t> trackMark{kNoMark}; // 交叉淡变时新歌曲开始的位置
+
+    // 解码进度（输出采样率下的帧），解码线程更新，播放线程无锁读取
+    std::atomic<long long> decodedFrames{0}; // 当前歌曲已写入环形缓冲区的帧位置
+    std::atomic<long long> trackFrames{0};   // 当前歌曲总帧数
+    void resetDecodePosition(long long frame); // 更换解码器或跳转后调用（需持有 engineMutex）
+
+    // 播放进度：以实际交给设备的帧数计算，UI 线程无锁读取
+    std::atomic<long long> playedFrames{0};  // 当前歌曲已输出到设备的帧位置
+    std::atomic<long long> segmentStart{0};  // 最近一次加载/跳转的起始帧
+    std::atomic<int> latencyFrames{0};       // 设备缓冲区延迟（帧）
+
     // 快进快退频率限制（每0.25秒最多1次）
     Uint32 lastSeekTime = 0;
-    
+
     // 音量控制
     int currentVolume = 80; // 默认音量80%
+    GainStage gainStage;    // 输出前的软件增益级
+
+    // DSP 处理链，只在音频回调中运行
+    DspChain dspChain;
+    ParametricEq* equalizer = nullptr; // 由 dspChain 持有
+    AudioTap tap;                      // 最终输出样本的抽头
+
+    // 交叉淡入淡出
+    std::atomic<int> crossfadeSeconds{0};
+
+    // 播放结束通知
+    std::function<void()> finishedCallback;
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,83 @@
+#ifndef PARAMETRIC_EQ_HPP
+#define PARAMETRIC_EQ_HPP
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "DspChain.hpp"
+
+enum class EqBandType { PEAK, LOW_SHELF, HIGH_SHELF };
+
+// 单个均衡频段
+struct EqBand {
+    EqBandType type = EqBandType::PEAK;
+    double frequency = 1000.0; // 中心/转折频率（Hz）
+    double gain = 0.0;         // 增益（dB）
+    double q = 1.0;            // 品质因数
+};
+
+// 均衡预设（保存在 config.json 的 equalizer.presets 中）
+struct EqPreset {
+    std::string name;
+    double preamp = 0.0;       // 前级增益（dB），用于给提升的频段留出余量
+    std::vector<EqBand> bands;
+
+    static std::vector<EqPreset> builtins();
+    static const char* typeName(EqBandType type);
+    static EqBandType parseType(const std::string& name);
+};
+
+// N 段双二阶参数均衡器
+// 每个频段对所有声道同时计算（4 声道一组的向量运算）；参数在控制线程计算好系数，
+// 音频回调用 try_lock 取走，不会等待锁
+class ParametricEq : public DspStage {
+public:
+    static constexpr int kMaxBands = 16;
+    static constexpr int kMaxChannels = 8;
+
+    const char* name() const override { return "参数均衡器"; }
+    void prepare(int sample_rate, int channels) override;
+    void process(float* data, size_t frames) override;
+    bool isEnabled() const override { return enabled.load(std::memory_order_relaxed); }
+
+    // 以下由控制线程调用
+    void setEnabled(bool on) { enabled.store(on, std::memory_order_relaxed); }
+    void setPreset(const EqPreset& preset);
+
+private:
+    typedef float Lanes __attribute__((vector_size(16))); // 4 个声道
+    static constexpr int kGroups = kMaxChannels / 4;
+
+    // 默认值为直通；bypass 的频段不参与计算（与直通滤波器等价，其状态保持为零）
+    struct Coeffs {
+        float b0 = 1, b1 = 0, b2 = 0, a1 = 0, a2 = 0;
+        bool bypass = true;
+    };
+
+    void rebuild(); // 调用者需持有 paramMutex
+    static Coeffs design(const EqBand& band, int sample_rate);
+
+    std::atomic<bool> enabled{false};
+
+    // 控制线程一侧，由 paramMutex 保护
+    std::mutex paramMutex;
+    std::vector<EqBand> bands;
+    double preampDb = 0.0;
+    int sampleRate = 44100;
+    int channelCount = 2;
+    Coeffs pending[kMaxBands]; // 第 k 个频段固定使用第 k 个位置，0 dB 的频段为直通
+    int pendingCount = 0;
+    float pendingPreamp = 1.0f;
+    std::atomic<bool> dirty{false};
+
+    // 音频回调一侧
+    Coeffs active[kMaxBands];
+    int activeCount = 0;
+    float activePreamp = 1.0f;
+    int channels = 2;
+    Lanes z1[kMaxBands][kGroups];
+    Lanes z2[kMaxBands][kGroups];
+};
+
+#endif // PARAMETRIC_EQ_HPP
@@ -0,0 +1,93 @@
+#ifndef PERSISTENCE_WRITER_HPP
+#define PERSISTENCE_WRITER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// 一次写入：serialize 在锁外执行，只能访问快照中复制的数据；为空时删除 path。
+// append 为 true 时把内容追加到 path 末尾（修改日志），否则原子替换整个文件。
+// obsolete 中的文件在 path 写入（或删除）成功后一并删除（例如转换格式后的旧文件、已合并的日志）；
+// 写入失败时在工作线程中调用 failed（可为空），之后按退避间隔再次调用同一个快照函数重试
+struct PersistTask {
+    fs::path path;
+    std::function<std::string()> serialize;
+    bool append = false;
+    std::vector<fs::path> obsolete;
+    std::function<void()> failed;
+};
+
+// 后台持久化：调用方只标记某个键（如 "config"、"playlist:3"）需要保存，
+// 工作线程在短时间内没有新修改（或距第一次修改超过上限）后统一写出，
+// 同一个键的多次修改只写一次。写入时先在工作线程中调用快照函数
+// （由它自行加锁复制数据），再在锁外序列化，最后通过临时文件 + fsync + rename 原子替换
+class PersistenceWriter {
+public:
+    // 快照函数：填写 task，返回 false 表示无需写入
+    using SnapshotFn = std::function<bool(PersistTask& task)>;
+
+    PersistenceWriter();
+    ~PersistenceWriter();
+    PersistenceWriter(const PersistenceWriter&) = delete;
+    PersistenceWriter& operator=(const PersistenceWriter&) = delete;
+
+    // 标记需要保存（同一个键只保留最新的快照函数）
+    void markDirty(const std::string& key, SnapshotFn snapshot);
+
+    // 立即写出所有待保存的内容并等待完成（调用者不能持有快照函数需要的锁）
+    void flush();
+
+    // 等待正在进行的写入完成，并在 resume 之前不再开始新的写入（标记照常登记）；
+    // 用于需要直接移动已写出文件的场合，调用者不能持有快照函数需要的锁
+    void pause();
+    void resume();
+
+    uint64_t getWriteCount() const { return writeCount.load(std::memory_order_relaxed); }
+
+    // 原子地替换文件内容：写入同目录的临时文件，fsync 后 rename
+    static bool writeAtomically(const fs::path& path, const std::string& data);
+    // 追加到文件末尾并 fsync（文件不存在时创建）
+    static bool appendDurably(const fs::path& path, const std::string& data);
+    // 同步 path 所在的目录，使新建、rename 或删除的目录项也已持久化
+    static void syncDirectory(const fs::path& path);
+
+    static constexpr std::chrono::milliseconds kQuietPeriod{300}; // 最后一次修改后等待的时间
+    static constexpr std::chrono::milliseconds kMaxDelay{3000};   // 第一次修改后最多等待的时间
+    static constexpr std::chrono::milliseconds kMaxRetryDelay{30000}; // 写入失败后重试的最长间隔（从 kQuietPeriod 起逐次加倍）
+
+private:
+    void worker();
+
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable cv;      // 通知工作线程
+    std::condition_variable doneCv;  // 通知 flush 写入已完成
+    std::unordered_map<std::string, SnapshotFn> pending;
+    std::vector<std::string> order; // 按第一次标记的顺序写出
+    // 写入失败、等待重试的键
+    struct Retry {
+        SnapshotFn snapshot;
+        std::chrono::steady_clock::time_point due;
+    };
+    std::unordered_map<std::string, Retry> retries;
+    std::unordered_map<std::string, int> failureCounts; // 连续失败次数，用于计算退避间隔
+    std::chrono::steady_clock::time_point firstDirty;
+    std::chrono::steady_clock::time_point lastDirty;
+    bool flushRequested = false;
+    bool busy = false;
+    bool stopping = false;
+    int pauseCount = 0;
+    std::atomic<uint64_t> writeCount{0};
+};
+
+#endif // PERSISTENCE_WRITER_HPP
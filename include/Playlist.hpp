@@ -6,6 +6,8 @@
 #include <filesystem>
 #include <chrono>
 #include <algorithm>
+#include <unordered_map>
+#include <cstdint>
 #include <nlohmann/json.hpp>
 
 namespace fs = std::filesystem;
@@ -30,8 +32,10 @@ struct SongEntry {
     std::string artist;
     std::string album;
     std::time_t modified_time;
+    int duration = 0;      // 时长（秒）
+    int track_number = 0;  // 音轨号
     
-    // 从文件路径获取元数据
+    // 从文件路径获取元数据（优先使用标签缓存）
     void loadMetadata();
     
     // JSON 序列化
@@ -48,31 +52,41 @@ public:
     std::string name;
     std::time_t created_time;
     std::time_t modified_time;
+    uint64_t revision = 0; // 已记录的修改次数，与修改日志中的记录序号对应
     
     // 歌曲管理
     void addSong(const std::string& path);
     void addSong(const SongEntry& song);
+    size_t addSongs(const std::vector<SongEntry>& new_songs); // 批量添加，返回实际添加数量
     void removeSong(int index);
     bool containsSong(const std::string& path) const;
+    int indexOf(const std::string& path) const; // 未找到返回 -1
     
-    // 排序
-    void sort(SortBy by, SortOrder order);
+    // 排序；permutation 非空时返回新顺序（permutation[i] 为排序前的位置）
+    void sort(SortBy by, SortOrder order, std::vector<uint32_t>* permutation = nullptr);
+    // 按给定顺序重排（order[i] 为新位置 i 上歌曲原来的位置），order 不是合法排列时返回 false
+    bool applyOrder(const std::vector<uint32_t>& order);
     
-    // 获取歌曲
+    // 获取歌曲（只读，修改需通过上面的接口以保持路径索引一致）
     const std::vector<SongEntry>& getSongs() const { return songs; }
-    std::vector<SongEntry>& getSongs() { return songs; }
     size_t size() const { return songs.size(); }
     bool empty() const { return songs.empty(); }
     
     // 清空
-    void clear() { songs.clear(); }
+    void clear() { songs.clear(); pathIndex.clear(); }
     
     // JSON 序列化
     json toJson() const;
     static Playlist fromJson(const json& j);
     
 private:
+    friend class PlaylistFile; // 二进制格式直接填充 songs
+
+    // 重建从 from 开始的路径索引
+    void reindex(size_t from = 0);
+
     std::vector<SongEntry> songs;
+    std::unordered_map<std::string, size_t> pathIndex; // 路径 -> songs 中的位置
 };
 
 #endif // PLAYLIST_HPP
\ No newline at end of file
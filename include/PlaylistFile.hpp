@@ -0,0 +1,117 @@
+#ifndef PLAYLIST_FILE_HPP
+#define PLAYLIST_FILE_HPP
+
+#include <cstdint>
+#include <ctime>
+#include <filesystem>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+#include "Playlist.hpp"
+
+namespace fs = std::filesystem;
+
+// 二进制歌单文件（.smpl），按小端序存储：
+//   文件头（版本 2 为 72 字节，版本 1 为不含 revision 的 64 字节）| 定长记录 × count | 字符串表
+// 记录中的字符串是指向字符串表的 (偏移, 长度)，相同的字符串（如歌手、专辑）只存一份；
+// 文件头中的校验和覆盖记录和字符串表。文件用 mmap 映射后可以直接按下标访问，不需要逐条分配内存
+struct PlaylistFileHeader {
+    char magic[4];          // "SMPL"
+    uint32_t version;
+    uint32_t headerSize;
+    uint32_t recordSize;
+    uint64_t count;         // 歌曲数
+    int64_t createdTime;
+    int64_t modifiedTime;
+    uint32_t nameOffset;    // 歌单名在字符串表中的位置
+    uint32_t nameLength;
+    uint64_t stringsSize;   // 字符串表字节数
+    uint64_t checksum;      // 记录 + 字符串表的校验和
+    uint64_t revision;      // 已包含的修改次数（版本 2 起）
+};
+static_assert(sizeof(PlaylistFileHeader) == 72, "歌单文件头必须是 72 字节");
+
+struct PlaylistFileRecord {
+    uint32_t pathOffset, pathLength;
+    uint32_t titleOffset, titleLength;
+    uint32_t artistOffset, artistLength;
+    uint32_t albumOffset, albumLength;
+    int64_t modifiedTime;
+    int32_t duration;
+    int32_t trackNumber;
+};
+static_assert(sizeof(PlaylistFileRecord) == 48, "歌单记录必须是 48 字节");
+
+// 歌曲的只读视图，字符串直接指向映射的文件内容
+struct SongView {
+    std::string_view path;
+    std::string_view title;
+    std::string_view artist;
+    std::string_view album;
+    std::time_t modified_time;
+    int duration;
+    int track_number;
+};
+
+// 只读映射一个 .smpl 文件；open 时校验文件头、边界和校验和
+class PlaylistView {
+public:
+    PlaylistView() = default;
+    ~PlaylistView();
+    PlaylistView(const PlaylistView&) = delete;
+    PlaylistView& operator=(const PlaylistView&) = delete;
+
+    bool open(const fs::path& path);
+    void close();
+
+    bool isOpen() const { return mapping != nullptr; }
+    size_t size() const { return isOpen() ? (size_t)header.count : 0; }
+    std::string_view name() const;
+    std::time_t createdTime() const { return (std::time_t)header.createdTime; }
+    std::time_t modifiedTime() const { return (std::time_t)header.modifiedTime; }
+    uint64_t revision() const { return header.revision; }
+    SongView song(size_t index) const;
+
+private:
+    std::string_view string(uint32_t offset, uint32_t length) const { return std::string_view(strings + offset, length); }
+
+    void* mapping = nullptr;
+    size_t mappingSize = 0;
+    PlaylistFileHeader header{}; // 复制出来，旧版本较短的文件头缺少的字段为 0
+    const PlaylistFileRecord* records = nullptr;
+    const char* strings = nullptr;
+};
+
+// 歌单文件读写：二进制格式与原有 JSON 格式可以无损互相转换
+class PlaylistFile {
+public:
+    static constexpr uint32_t kVersion = 2;
+    static constexpr uint32_t kHeaderSizeV1 = 64;
+    static constexpr const char* kBinaryExtension = ".smpl";
+    static constexpr const char* kJsonExtension = ".json";
+
+    // 编码为二进制文件内容
+    static std::string encode(const Playlist& playlist);
+    // 由映射的视图构造歌单
+    static Playlist decode(const PlaylistView& view);
+
+    // 流式解析 JSON 歌单：用 SAX 接口直接填充 SongEntry，不构造 json DOM
+    static bool parseJson(const char* data, size_t size, Playlist& out);
+    // 流式写出 JSON 歌单，不构造 DOM，输出与 toJson().dump(4) 逐字节相同
+    static void writeJson(const Playlist& playlist, std::string& out);
+
+    // 按扩展名读取 .smpl 或 .json，文件不存在或损坏时返回 false
+    static bool load(const fs::path& path, Playlist& out);
+    // 按扩展名序列化为 .smpl 或 .json 的文件内容
+    static std::string serialize(const Playlist& playlist, const fs::path& path);
+
+    // smp --convert-playlist <输入> <输出>：按扩展名在两种格式之间转换
+    static bool convert(const fs::path& from, const fs::path& to);
+    // smp --benchmark-playlist：比较十万首歌单各种读写方式的耗时、峰值内存和文件大小
+    static void benchmark(std::ostream& out);
+
+    // 记录和字符串表的校验和（按 8 字节分组的 FNV-1a）
+    static uint64_t checksum(const char* data, size_t size);
+};
+
+#endif // PLAYLIST_FILE_HPP
@@ -0,0 +1,36 @@
+#ifndef PLAYLIST_JOURNAL_HPP
+#define PLAYLIST_JOURNAL_HPP
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include "Playlist.hpp"
+
+namespace fs = std::filesystem;
+
+// 歌单修改日志（playlist_N.journal）：每次添加、删除、重命名、排序只追加一条记录，
+// 不必重写整个歌单文件。记录格式（小端序）：
+//   长度 u32 | 校验和 u64 | 序号 u64 | 歌单修改时间 i64 | 操作 u8 | 操作数据
+// 序号即执行后的 Playlist::revision；歌单文件中保存了它已包含的序号，
+// 回放时跳过已包含的记录，遇到不完整、校验失败或序号不连续的记录就停止。
+// 日志超过 kCompactBytes 后由后台写入线程合并回歌单文件并删除日志
+class PlaylistJournal {
+public:
+    static constexpr const char* kExtension = ".journal";
+    static constexpr uint64_t kCompactBytes = 256 * 1024;
+
+    // 以下函数在歌单已经执行对应修改之后调用：revision 加 1，并把记录追加到 out
+    // 添加歌曲（songs 为传给 addSong/addSongs 的歌曲，已存在的会在回放时同样被忽略）
+    static void recordAdd(Playlist& playlist, const SongEntry* songs, size_t count, std::string& out);
+    static void recordRemove(Playlist& playlist, int index, std::string& out);
+    static void recordRename(Playlist& playlist, std::string& out);
+    // order 为 Playlist::sort 返回的排列
+    static void recordSort(Playlist& playlist, const std::vector<uint32_t>& order, std::string& out);
+
+    // 把日志中尚未包含的记录应用到 playlist；valid_bytes 返回可用记录的长度，
+    // 日志不存在时返回 true，有损坏或缺失的记录时返回 false（应重写歌单文件）
+    static bool replay(const fs::path& path, Playlist& playlist, uint64_t& valid_bytes);
+};
+
+#endif // PLAYLIST_JOURNAL_HPP
@@ -0,0 +1,78 @@
+#ifndef RING_BUFFER_HPP
+#define RING_BUFFER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// 单生产者/单消费者无锁环形缓冲区
+// 生产者线程只调用 write/space/writePosition，消费者线程只调用 read/available/discardUntil
+// 读写位置单调递增（64位不会回绕），下标对容量取模；容量向上取整为 2 的幂
+template <typename T>
+class RingBuffer {
+public:
+    explicit RingBuffer(size_t min_capacity = 0) { reset(min_capacity); }
+
+    // 重新分配容量，调用时两端都不能在访问缓冲区
+    void reset(size_t min_capacity) {
+        size_t cap = 1;
+        while (cap < min_capacity) cap <<= 1;
+        data.assign(cap, T());
+        mask = cap - 1;
+        head.store(0, std::memory_order_relaxed);
+        tail.store(0, std::memory_order_relaxed);
+    }
+
+    size_t capacity() const { return data.size(); }
+
+    // 可读元素数（任意线程调用结果都只是近似值）
+    size_t available() const {
+        return (size_t)(head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire));
+    }
+    size_t space() const { return capacity() - available(); }
+
+    uint64_t writePosition() const { return head.load(std::memory_order_acquire); }
+    uint64_t readPosition() const { return tail.load(std::memory_order_acquire); }
+
+    // 生产者：写入最多 count 个元素，返回实际写入数
+    size_t write(const T* src, size_t count) {
+        uint64_t w = head.load(std::memory_order_relaxed);
+        uint64_t r = tail.load(std::memory_order_acquire);
+        count = std::min(count, capacity() - (size_t)(w - r));
+        size_t first = std::min(count, capacity() - (size_t)(w & mask));
+        std::memcpy(&data[w & mask], src, first * sizeof(T));
+        std::memcpy(&data[0], src + first, (count - first) * sizeof(T));
+        head.store(w + count, std::memory_order_release);
+        return count;
+    }
+
+    // 消费者：读取最多 count 个元素，返回实际读取数
+    size_t read(T* dst, size_t count) {
+        uint64_t r = tail.load(std::memory_order_relaxed);
+        uint64_t w = head.load(std::memory_order_acquire);
+        count = std::min(count, (size_t)(w - r));
+        size_t first = std::min(count, capacity() - (size_t)(r & mask));
+        std::memcpy(dst, &data[r & mask], first * sizeof(T));
+        std::memcpy(dst + first, &data[0], (count - first) * sizeof(T));
+        tail.store(r + count, std::memory_order_release);
+        return count;
+    }
+
+    // 消费者：丢弃 position 之前的所有数据（用于跳转/切歌时清空旧音频）
+    void discardUntil(uint64_t position) {
+        uint64_t r = tail.load(std::memory_order_relaxed);
+        uint64_t w = head.load(std::memory_order_acquire);
+        position = std::min(position, w);
+        if (position > r) tail.store(position, std::memory_order_release);
+    }
+
+private:
+    std::vector<T> data;
+    size_t mask = 0;
+    alignas(64) std::atomic<uint64_t> head{0}; // 写位置
+    alignas(64) std::atomic<uint64_t> tail{0}; // 读位置
+};
+
+#endif // RING_BUFFER_HPP
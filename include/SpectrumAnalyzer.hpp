@@ -0,0 +1,48 @@
+#ifndef SPECTRUM_ANALYZER_HPP
+#define SPECTRUM_ANALYZER_HPP
+
+#include <complex>
+#include <cstdint>
+#include <vector>
+#include "AudioTap.hpp"
+
+// 单声道电平
+struct LevelMeter {
+    float peak = 0.0f;     // 峰值（线性）
+    float rms = 0.0f;      // 均方根（线性）
+    float peakHold = 0.0f; // 峰值保持（线性，缓慢回落）
+};
+
+// 频谱分析器：在 UI 线程中从 AudioTap 取最近的样本做 FFT，
+// 按对数频率分组为若干频段，并计算左右声道的峰值/RMS 电平
+// 只在播放界面显示时调用 update，其他界面不产生任何开销
+class SpectrumAnalyzer {
+public:
+    static constexpr size_t kFftSize = 2048;
+
+    SpectrumAnalyzer();
+
+    // 读取新样本并更新频段和电平；elapsed_ms 用于计算回落速度
+    void update(const AudioTap& tap, int sample_rate, int bands, double elapsed_ms);
+
+    // 各频段高度（0-1，已平滑）
+    const std::vector<float>& getBands() const { return bandLevels; }
+    const LevelMeter& getMeter(int channel) const { return meters[channel]; }
+
+    static constexpr double kFloorDb = -72.0; // 频谱显示下限
+
+private:
+    void fft();
+    void decay(double elapsed_ms);
+
+    std::vector<float> window;                  // Hann 窗
+    std::vector<std::complex<float>> twiddles;  // 旋转因子
+    std::vector<size_t> bitReverse;
+    std::vector<std::complex<float>> spectrum;  // FFT 工作区
+    std::vector<float> frames;                  // 从 AudioTap 取出的交错样本
+    std::vector<float> bandLevels;
+    LevelMeter meters[AudioTap::kChannels];
+    uint64_t lastPosition = 0;
+};
+
+#endif // SPECTRUM_ANALYZER_HPP
@@ -0,0 +1,49 @@
+#ifndef TAG_CACHE_HPP
+#define TAG_CACHE_HPP
+
+#include <string>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+// 缓存的标签数据
+struct CachedTags {
+    std::uintmax_t size = 0;  // 文件大小
+    std::int64_t mtime = 0;   // 文件修改时间（file_time_type 原始计数）
+    std::string title;
+    std::string artist;
+    std::string album;
+    int duration = 0;         // 时长（秒）
+    int track_number = 0;     // 音轨号
+};
+
+// 持久化的标签缓存：以 (路径, 大小, 修改时间) 为键，避免重复用 TagLib 解析文件
+// 数据保存在 ~/.config/simple_music_player/tag_cache.json，线程安全
+class TagCache {
+public:
+    static TagCache& instance();
+
+    // 查找缓存，只有大小和修改时间都匹配时才命中
+    bool lookup(const std::string& path, std::uintmax_t size, std::int64_t mtime, CachedTags& out);
+
+    // 写入或更新缓存条目
+    void store(const std::string& path, const CachedTags& tags);
+
+    // 将修改写回磁盘（无修改时不写）
+    void save();
+
+private:
+    TagCache() = default;
+    void loadIfNeeded();
+    static fs::path getCacheFilePath();
+
+    std::mutex mutex;
+    std::unordered_map<std::string, CachedTags> entries;
+    bool loaded = false;
+    bool dirty = false;
+};
+
+#endif // TAG_CACHE_HPP
@@ -0,0 +1,47 @@
+#ifndef TEXT_LAYOUT_HPP
+#define TEXT_LAYOUT_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// 一个字符串的排版信息：UTF-8 只解码一次，记录每个字符的结束位置和累计显示宽度
+struct TextMetrics {
+    int width = 0;                 // 总显示宽度（终端列数）
+    std::vector<uint32_t> ends;    // 第 i 个字符结束的字节位置
+    std::vector<uint32_t> columns; // 前 i+1 个字符的显示宽度
+};
+
+// 按终端显示宽度（wcwidth 语义：中日韩字符占 2 列，组合字符占 0 列）处理文本
+// 截断和折行只在字符边界进行，不会拆开 UTF-8 多字节序列
+// 所有界面渲染共用 shared() 实例，字符串的宽度信息缓存后每帧只需查表
+class TextLayout {
+public:
+    static TextLayout& shared(); // 只在 UI 线程使用
+
+    const TextMetrics& metrics(const std::string& text);
+    int width(const std::string& text) { return metrics(text).width; }
+
+    // 超出 width 列时截断并加省略号
+    std::string truncate(const std::string& text, int width);
+    // 用空格补齐到 width 列（用于对齐）
+    std::string pad(const std::string& text, int width);
+
+    // 按 width 列折行：优先在空格或宽字符之后断开
+    static void wrap(std::string_view text, int width, std::vector<std::string>& out);
+
+    static int displayWidth(std::string_view text);
+    static int charWidth(char32_t cp);
+    // 解码 pos 处的一个字符，返回其字节数；非法序列按 1 字节的 U+FFFD 处理
+    static size_t decode(std::string_view text, size_t pos, char32_t& cp);
+
+private:
+    static void measure(std::string_view text, TextMetrics& out);
+
+    static constexpr size_t kMaxEntries = 4096; // 缓存条目上限，超出时整体清空
+    std::unordered_map<std::string, TextMetrics> cache;
+};
+
+#endif // TEXT_LAYOUT_HPP
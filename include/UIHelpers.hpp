@@ -107,11 +107,21 @@ extern const HelpInfo ADD_TO_PLAYLIST_HELP;
 extern const HelpInfo SORT_MENU_HELP;
 extern const HelpInfo SETTINGS_HELP;
 extern const HelpInfo PLAY_MODE_HELP;
+extern const HelpInfo CROSSFADE_HELP;
+extern const HelpInfo REPLAY_GAIN_HELP;
+extern const HelpInfo EQUALIZER_HELP;
+
+// 行内容提供函数：根据项目索引返回显示文本，只对可见行调用
+using RowProvider = std::function<std::string(int)>;
 
 // 绘制分页菜单
 void drawPageMenu(const std::string& title, const std::vector<std::string>& options, 
                   PageMenu& page_menu, bool show_numbers = true);
 
+// 绘制分页菜单（虚拟列表版本），每帧开销只与可见行数有关
+void drawPageMenu(const std::string& title, int total_items, const RowProvider& row_provider,
+                  PageMenu& page_menu, bool show_numbers = true);
+
 // 绘制帮助信息
 void drawHelp(const HelpInfo& help);
 
@@ -0,0 +1,72 @@
+#ifndef WAVEFORM_CACHE_HPP
+#define WAVEFORM_CACHE_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// 整首歌的波形概要：固定数量的时间段，每段保存最小/最大样本（-127..127）
+struct WaveformSummary {
+    static constexpr int kBuckets = 2048; // 每首约 4 KB
+
+    std::string path;
+    std::vector<int8_t> mins;
+    std::vector<int8_t> maxs;
+
+    // 返回 [begin, end) 比例范围内的最大幅度（0-1）
+    float amplitude(double begin, double end) const;
+};
+
+// 波形缓存：后台线程解码当前歌曲生成波形概要，结果以 (路径, 大小, 修改时间)
+// 为键保存在 ~/.config/simple_music_player/waveforms/ 中，最多保留 kMaxFiles 个文件，
+// 超出时删除最久未使用的；一次只处理最近请求的歌曲，切歌时正在进行的计算会被取消
+class WaveformCache {
+public:
+    static constexpr size_t kMaxFiles = 2000; // 约 8 MB
+
+    WaveformCache();
+    ~WaveformCache();
+    WaveformCache(const WaveformCache&) = delete;
+    WaveformCache& operator=(const WaveformCache&) = delete;
+
+    // 请求某首歌的波形（与上次请求相同时忽略）
+    void request(const std::string& path);
+
+    // 当前请求歌曲的波形，尚未生成时返回空
+    std::shared_ptr<const WaveformSummary> current() const;
+
+private:
+    void worker();
+    // 生成波形；请求改变时返回 false
+    bool compute(const std::string& path, uint64_t generation, WaveformSummary& out);
+    bool loadFile(const fs::path& file, const std::string& path, std::uintmax_t size,
+                  std::int64_t mtime, WaveformSummary& out) const;
+    void saveFile(const fs::path& file, const WaveformSummary& summary, std::uintmax_t size,
+                  std::int64_t mtime) const;
+    // 缓存文件超过 kMaxFiles 个时按修改时间删除最旧的
+    static void prune(const fs::path& dir);
+    bool cancelled(uint64_t generation) const {
+        return stopping || requestGeneration.load(std::memory_order_relaxed) != generation;
+    }
+    static fs::path getCacheDir();
+    static fs::path getCacheFile(const std::string& path);
+
+    std::thread thread;
+    mutable std::mutex mutex;
+    std::condition_variable cv;
+    std::string requested;
+    std::atomic<uint64_t> requestGeneration{0};
+    uint64_t doneGeneration = 0;
+    std::shared_ptr<const WaveformSummary> summary;
+    std::atomic<bool> stopping{false};
+};
+
+#endif // WAVEFORM_CACHE_HPP
@@ -1,4 +1,7 @@
 #include "AppController.hpp"
+#include "TagCache.hpp"
+#include "PlaylistFile.hpp"
+#include "PlaylistJournal.hpp"
 #include <fstream>
 #include <algorithm>
 #include <random>
@@ -8,44 +11,190 @@ using json = nlohmann::json;
 
 AppController::AppController() {
     init();
+    player.setFinishedCallback([this]() { onTrackFinished(); });
+    player.setGainResolver([this](const std::string& path, const TrackMetadata& tags) {
+        return loudness.gainFor(path, tags, replayGainMode);
+    });
     playerThread = std::thread(&AppController::playbackLoop, this);
 }
 
 AppController::~AppController() {
     running = false;
+    wakePlaybackThread();
     if (playerThread.joinable()) playerThread.join();
-    // 程序退出时保存配置
+    if (loaderThread.joinable()) loaderThread.join();
+    importProgress.cancelled = true;
+    if (importThread.joinable()) importThread.join();
+    // 程序退出时保存配置，并等待所有待写入的内容落盘
     saveConfig();
+    persistence.flush();
+    TagCache::instance().save();
 }
 
 void AppController::init() {
+    // main 处理完命令行模式后构造控制器时运行，只读入配置和歌单元信息，
+    // 歌单内容和响度缓存交给后台线程，界面可以立即显示
     loadConfig();
+    applyEqualizer();
     loadPlaylists();
     
-    // 如果当前是乱序模式且有播放列表，生成乱序列表
-    if (mode == PlayMode::SHUFFLE && currentPlaylistIndex >= 0 && 
-        currentPlaylistIndex < (int)playlists.size()) {
-        auto& playlist = playlists[currentPlaylistIndex];
-        if (!playlist->empty()) {
-            generateShuffleOrder();
-            
-            // 确保currentSongIndex在乱序列表的有效范围内
-            if (currentSongIndex < 0 || currentSongIndex >= (int)shuffleOrder.size()) {
-                currentSongIndex = 0;
-            }
-        }
-    }
-    
     // 不再创建默认歌单，用户需要手动创建
     if (currentPlaylistIndex >= 0 && currentPlaylistIndex < (int)playlists.size()) {
         needLoad = true;
-        isStartingUp = true; // 设置为启动状态
+        isStartingUp = true; // 设置为启动状态，当前歌单读入后开始播放
+    }
+    loaderThread = std::thread(&AppController::loadPlaylistBodies, this);
+}
+
+void AppController::loadPlaylistBodies() {
+    // 任务顺序：当前歌单、响度缓存、其余歌单；工作线程按顺序领取，前两项同时进行
+    std::vector<UnloadedPlaylist> jobs;
+    bool has_current = false;
+    {
+        std::lock_guard<std::mutex> lock(dataMutex);
+        jobs = unloadedPlaylists;
+        if (currentPlaylistIndex >= 0 && currentPlaylistIndex < (int)playlists.size()) {
+            auto current = playlists[currentPlaylistIndex];
+            auto it = std::find_if(jobs.begin(), jobs.end(),
+                                   [&](const UnloadedPlaylist& job) { return job.playlist == current; });
+            if (it != jobs.end()) {
+                std::rotate(jobs.begin(), it, it + 1);
+                has_current = true;
+            }
+        }
+    }
+
+    // 当前歌单和响度缓存都就绪后才恢复播放，避免首曲因缺少响度数据而被重复分析
+    std::atomic<int> startup_pending{has_current ? 2 : 1};
+    auto startup_done = [&]() {
+        if (--startup_pending == 0) {
+            startupReady = true;
+            wakePlaybackThread();
+        }
+    };
+    size_t loudness_job = has_current ? 1 : 0;
+    size_t total = jobs.size() + 1;
+
+    std::atomic<size_t> next{0};
+    auto worker = [&]() {
+        for (size_t i = next++; i < total && running; i = next++) {
+            if (i == loudness_job) {
+                loudness.loadCache();
+                startup_done();
+                continue;
+            }
+            const UnloadedPlaylist& job = jobs[i < loudness_job ? i : i - 1];
+            // 读文件不持有 dataMutex：期间删除歌单使文件前移时按新的编号重读；
+            // 已被按需加载或删除时不再读取
+            while (running) {
+                int file_index;
+                uint64_t generation;
+                {
+                    std::lock_guard<std::mutex> lock(dataMutex);
+                    auto it = std::find_if(unloadedPlaylists.begin(), unloadedPlaylists.end(),
+                                           [&](const UnloadedPlaylist& entry) { return entry.playlist == job.playlist; });
+                    if (it == unloadedPlaylists.end()) break;
+                    file_index = it->fileIndex;
+                    generation = playlistFilesGeneration;
+                }
+                Playlist body;
+                bool rewrite = false;
+                uint64_t journal_bytes = 0;
+                bool ok = readPlaylistFile(file_index, body, rewrite, journal_bytes);
+                std::lock_guard<std::mutex> lock(dataMutex);
+                if (generation != playlistFilesGeneration) continue;
+                installPlaylistBody(job.playlist, ok ? &body : nullptr, rewrite, journal_bytes);
+                break;
+            }
+            if (i == 0 && has_current) startup_done();
+        }
+    };
+
+    unsigned int threads = std::max(1u, std::thread::hardware_concurrency());
+    unsigned int workers = (unsigned int)std::min<size_t>(threads, total);
+    std::vector<std::thread> pool;
+    for (unsigned int t = 1; t < workers; ++t) {
+        pool.emplace_back(worker);
+    }
+    worker(); // 调用线程也参与工作
+    for (auto& t : pool) t.join();
+    if (!running) return;
+
+    // 全部读入后再分析响度（已缓存的只检查文件是否变化），此时缓存已可用
+    std::lock_guard<std::mutex> lock(dataMutex);
+    enqueueLoudnessAnalysis();
+}
+
+bool AppController::readPlaylistFile(int index, Playlist& out, bool& rewrite, uint64_t& journal_bytes) {
+    rewrite = false;
+    journal_bytes = 0;
+    bool ok = PlaylistFile::load(getPlaylistFilePath(index, binaryPlaylists), out);
+    if (!ok) {
+        // 只有另一种格式的文件时（如旧版本的 .json）读入后由 markPlaylistDirty 转换
+        ok = PlaylistFile::load(getPlaylistFilePath(index, !binaryPlaylists), out);
+        rewrite = ok;
+    }
+    if (!ok) return false;
+    // 回放上次合并之后的修改；日志末尾不完整（写到一半时崩溃）时重写歌单文件并丢弃日志
+    if (!PlaylistJournal::replay(getJournalFilePath(index), out, journal_bytes)) rewrite = true;
+    if (journal_bytes > PlaylistJournal::kCompactBytes) rewrite = true;
+    return true;
+}
+
+void AppController::installPlaylistBody(const std::shared_ptr<Playlist>& playlist, Playlist* body, bool rewrite, uint64_t journal_bytes) {
+    auto it = std::find_if(unloadedPlaylists.begin(), unloadedPlaylists.end(),
+                           [&](const UnloadedPlaylist& entry) { return entry.playlist == playlist; });
+    if (it == unloadedPlaylists.end()) return; // 已按需加载，或已被删除
+    unloadedPlaylists.erase(it);
+    // 文件不存在或损坏时保留元信息中的名称
+    if (body) *playlist = std::move(*body);
+
+    int index = (int)(std::find(playlists.begin(), playlists.end(), playlist) - playlists.begin());
+    if (index >= (int)playlists.size()) return;
+    JournalState& state = journals[playlist.get()];
+    state.onDisk = journal_bytes;
+    // 读取失败时保留原文件，但之后的修改不能只追加到日志，要写出完整的歌单文件
+    if (!body) state.rewrite = true;
+    if (rewrite) markPlaylistDirty(index);
+
+    // 如果当前是乱序模式，当前歌单读入后生成乱序列表
+    if (index == currentPlaylistIndex && mode == PlayMode::SHUFFLE && !playlist->empty()) {
+        generateShuffleOrder();
+        
+        // 确保currentSongIndex在乱序列表的有效范围内
+        if (currentSongIndex < 0 || currentSongIndex >= (int)shuffleOrder.size()) {
+            currentSongIndex = 0;
+        }
     }
 }
 
+void AppController::ensurePlaylistLoaded(int index) {
+    if (index < 0 || index >= (int)playlists.size()) return;
+    auto playlist = playlists[index];
+    auto it = std::find_if(unloadedPlaylists.begin(), unloadedPlaylists.end(),
+                           [&](const UnloadedPlaylist& entry) { return entry.playlist == playlist; });
+    if (it == unloadedPlaylists.end()) return;
+    Playlist body;
+    bool rewrite = false;
+    uint64_t journal_bytes = 0;
+    bool ok = readPlaylistFile(it->fileIndex, body, rewrite, journal_bytes);
+    installPlaylistBody(playlist, ok ? &body : nullptr, rewrite, journal_bytes);
+}
+
+void AppController::loadPlaylistNow(int index) {
+    std::lock_guard<std::mutex> lock(dataMutex);
+    ensurePlaylistLoaded(index);
+}
+
 void AppController::playbackLoop() {
     while (running) {
         std::string path_to_load = "";
+        // 在检查状态之前取走标志，之后到达的通知会让下一次等待立即返回
+        bool finished = trackFinished.exchange(false);
+        wakeRequested = false;
+        if (needGainRefresh.exchange(false)) {
+            player.refreshTrackGain();
+        }
         
         {
             std::lock_guard<std::mutex> lock(dataMutex);
@@ -67,14 +216,17 @@ void AppController::playbackLoop() {
                 if (!playlist->empty()) {
                     // 自动切歌判断逻辑
                     if (needLoad) {
-                        // 需要加载歌曲（启动时恢复播放或手动切歌）
-                        path_to_load = getCurrentSong().path;
-                        needLoad = false;
-                        // 如果是启动状态，现在应该结束了
-                        if (isStartingUp) {
-                            isStartingUp = false;
+                        // 需要加载歌曲（启动时恢复播放或手动切歌）；
+                        // 启动时先等当前歌单和响度缓存在后台读入，读入后会再唤醒本线程
+                        if (startupReady) {
+                            path_to_load = getCurrentSong().path;
+                            needLoad = false;
+                            // 如果是启动状态，现在应该结束了
+                            if (isStartingUp) {
+                                isStartingUp = false;
+                            }
                         }
-                    } else if (!player.isPlaying() && !player.isPaused() && !isStartingUp) {
+                    } else if (finished && !isStartingUp) {
                         // 歌曲播放完毕，根据播放模式自动处理
                         if (mode == PlayMode::SINGLE) {
                             // 单曲循环模式：重新播放当前歌曲
@@ -90,29 +242,142 @@ void AppController::playbackLoop() {
         }
 
         if (!path_to_load.empty()) {
-            player.load(path_to_load);
-            player.play();
+            prefetchDone = false;
+            crossfadeDone = false;
+            if (player.load(path_to_load)) {
+                player.play();
+                waveforms.request(path_to_load);
+                prioritizeNextLoudness();
+            } else {
+                // 加载失败：稍等后按播放结束处理，跳到下一首（避免坏文件导致忙等）
+                std::unique_lock<std::mutex> wl(wakeMutex);
+                playbackCv.wait_for(wl, std::chrono::milliseconds(100),
+                                    [this]() { return !running || needLoad; });
+                if (!needLoad) trackFinished = true;
+                continue;
+            }
         }
         
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        // 距离歌曲结束不到 kPrefetchLeadSeconds 时预加载下一首，切歌时只需交换指针；
+        // 开启淡入淡出时，在剩余时间等于淡变时长时开始切换到下一首。
+        // 淡变从解码写位置开始混合，它比播放进度超前一个环形缓冲区，所以按尚未解码的时长计算
+        auto wake_after = std::chrono::milliseconds::max();
+        if (player.isPlaying() && !player.isPaused()) {
+            int crossfade = (mode == PlayMode::SINGLE) ? 0 : player.getCrossfadeSeconds();
+            double lead = std::max(kPrefetchLeadSeconds, crossfade + 2.0);
+            double remaining = player.getDecodeRemainingSeconds();
+            // 缓冲区未满时解码位置还会一下子前进这么多，提前醒来重新计算（至少间隔 20 毫秒）
+            double headroom = player.getBufferSpaceSeconds();
+            if (!prefetchDone) {
+                if (remaining <= lead) {
+                    std::string next_path;
+                    {
+                        std::lock_guard<std::mutex> lock(dataMutex);
+                        next_path = peekNextSongPath();
+                    }
+                    player.prefetch(next_path);
+                    prefetchDone = true;
+                    continue;
+                }
+                wake_after = std::chrono::milliseconds((long long)(std::max(0.02, remaining - lead - headroom) * 1000));
+            } else if (crossfade > 0 && !crossfadeDone) {
+                if (remaining <= crossfade) {
+                    crossfadeNext();
+                    continue;
+                }
+                wake_after = std::chrono::milliseconds((long long)(std::max(0.02, remaining - crossfade - headroom) * 1000));
+            }
+        }
+        
+        // 没有事件时一直休眠，不再轮询（需要预加载时定时醒来）
+        auto has_event = [this]() {
+            return !running || needLoad || trackFinished || needShuffleUpdate || wakeRequested;
+        };
+        std::unique_lock<std::mutex> wl(wakeMutex);
+        if (wake_after == std::chrono::milliseconds::max()) {
+            playbackCv.wait(wl, has_event);
+        } else {
+            playbackCv.wait_for(wl, wake_after, has_event);
+        }
     }
 }
 
-// --- 目录扫描 ---
-void AppController::scanDirectoryForSongs(const std::string& dir_path, std::vector<std::string>& result) {
-    result.clear();
-    fs::path m_path = dir_path;
-    if (!fs::exists(m_path)) return;
+void AppController::crossfadeNext() {
+    std::string next_path;
+    int previous_index;
+    {
+        std::lock_guard<std::mutex> lock(dataMutex);
+        if (currentPlaylistIndex < 0 || currentPlaylistIndex >= (int)playlists.size() ||
+            playlists[currentPlaylistIndex]->empty()) {
+            crossfadeDone = true;
+            return;
+        }
+        previous_index = currentSongIndex;
+        currentSongIndex = (currentSongIndex + 1) % playlists[currentPlaylistIndex]->size();
+        next_path = getCurrentSong().path;
+    }
+    
+    if (player.crossfadeTo(next_path)) {
+        // 新歌曲开始播放，重新安排预加载
+        prefetchDone = false;
+        crossfadeDone = false;
+        waveforms.request(next_path);
+        prioritizeNextLoudness();
+    } else {
+        // 下一首无法打开：让当前歌曲自然结束，由结束事件处理
+        std::lock_guard<std::mutex> lock(dataMutex);
+        currentSongIndex = previous_index;
+        crossfadeDone = true;
+    }
+}
 
-    for (const auto& entry : fs::directory_iterator(m_path)) {
-        if (!entry.is_regular_file()) continue;
-        std::string ext = entry.path().extension().string();
-        std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
-        if (ext == ".mp3" || ext == ".flac") {
-            result.push_back(entry.path().string());
+std::string AppController::peekNextSongPath() const {
+    if (currentPlaylistIndex < 0 || currentPlaylistIndex >= (int)playlists.size()) return "";
+    auto& playlist = playlists[currentPlaylistIndex];
+    if (playlist->empty()) return "";
+    if (mode == PlayMode::SINGLE) {
+        return getCurrentSong().path;
+    }
+    return getSongAt((currentSongIndex + 1) % playlist->size()).path;
+}
+
+void AppController::prioritizeNextLoudness() {
+    if (replayGainMode == ReplayGainMode::OFF) return;
+    std::string next_path;
+    {
+        std::lock_guard<std::mutex> lock(dataMutex);
+        next_path = peekNextSongPath();
+    }
+    // 预加载时就需要下一首的增益，提前安排分析
+    loudness.prioritize(next_path);
+}
+
+void AppController::enqueueLoudnessAnalysis() {
+    std::vector<std::string> paths;
+    for (const auto& playlist : playlists) {
+        for (const auto& song : playlist->getSongs()) {
+            paths.push_back(song.path);
         }
     }
-    std::sort(result.begin(), result.end());
+    loudness.enqueue(paths);
+}
+
+void AppController::wakePlaybackThread() {
+    // 持有 wakeMutex 再通知，避免与等待条件检查之间的竞争导致唤醒丢失
+    {
+        std::lock_guard<std::mutex> wl(wakeMutex);
+        wakeRequested = true;
+    }
+    playbackCv.notify_one();
+}
+
+void AppController::onTrackFinished() {
+    // 由 MusicPlayer 解码线程调用：只设置标志并唤醒播放线程
+    {
+        std::lock_guard<std::mutex> wl(wakeMutex);
+        trackFinished = true;
+    }
+    playbackCv.notify_one();
 }
 
 // --- 接口实现 ---
@@ -125,6 +390,7 @@ void AppController::nextSong() {
             needLoad = true;
         }
     }
+    wakePlaybackThread();
 }
 
 void AppController::prevSong() { 
@@ -136,22 +402,31 @@ void AppController::prevSong() {
             needLoad = true;
         }
     }
+    wakePlaybackThread();
 }
 
-void AppController::togglePause() { player.isPaused() ? player.resume() : player.pause(); }
+void AppController::togglePause() {
+    player.isPaused() ? player.resume() : player.pause();
+    wakePlaybackThread(); // 重新计算预加载时间
+}
 
 void AppController::seekForward() {
     player.seekForward();
+    wakePlaybackThread();
 }
 
 void AppController::seekBackward() {
     player.seekBackward();
+    wakePlaybackThread();
 }
 
 void AppController::playAtIndex(int index) { 
-    std::lock_guard<std::mutex> l(dataMutex); 
-    currentSongIndex = index; 
-    needLoad = true; 
+    {
+        std::lock_guard<std::mutex> l(dataMutex); 
+        currentSongIndex = index; 
+        needLoad = true; 
+    }
+    wakePlaybackThread();
 }
 
 void AppController::togglePlayMode() {
@@ -199,17 +474,8 @@ void AppController::togglePlayMode() {
                 // 切换到乱序模式：生成乱序列表
                 generateShuffleOrder();
                 
-                // 在乱序列表中查找当前歌曲
-                int found_index = -1;
-                for (size_t i = 0; i < shuffleOrder.size(); ++i) {
-                    int original_index = shuffleOrder[i];
-                    if (original_index >= 0 && original_index < (int)playlist->size()) {
-                        if (playlist->getSongs()[original_index].path == current_song_path) {
-                            found_index = i;
-                            break;
-                        }
-                    }
-                }
+                // 通过路径索引和逆映射直接定位当前歌曲
+                int found_index = shuffledIndexOf(playlist->indexOf(current_song_path));
                 
                 if (found_index >= 0) {
                     currentSongIndex = found_index;
@@ -226,7 +492,7 @@ void AppController::togglePlayMode() {
                     }
                 }
                 // 清空乱序列表
-                shuffleOrder.clear();
+                clearShuffleOrder();
             } else {
                 // 切换到单曲循环模式
                 // 单曲循环模式不需要特殊处理，保持当前状态
@@ -238,23 +504,25 @@ void AppController::togglePlayMode() {
                     }
                 }
                 // 清空乱序列表（单曲循环不需要乱序列表）
-                shuffleOrder.clear();
+                clearShuffleOrder();
             }
         }
     }
     
     saveConfig();
     needShuffleUpdate = true;
+    wakePlaybackThread();
 }
 
 // 生成乱序播放列表
 void AppController::generateShuffleOrder() {
-    shuffleOrder.clear();
+    clearShuffleOrder();
     if (currentPlaylistIndex >= 0 && currentPlaylistIndex < (int)playlists.size()) {
         auto& playlist = playlists[currentPlaylistIndex];
         int size = playlist->size();
         
         // 创建顺序索引
+        shuffleOrder.reserve(size);
         for (int i = 0; i < size; ++i) {
             shuffleOrder.push_back(i);
         }
@@ -263,9 +531,27 @@ void AppController::generateShuffleOrder() {
         std::random_device rd;
         std::mt19937 g(rd());
         std::shuffle(shuffleOrder.begin(), shuffleOrder.end(), g);
+        
+        // 同步生成逆映射
+        shufflePosition.assign(size, -1);
+        for (int i = 0; i < size; ++i) {
+            shufflePosition[shuffleOrder[i]] = i;
+        }
     }
 }
 
+void AppController::clearShuffleOrder() {
+    shuffleOrder.clear();
+    shufflePosition.clear();
+}
+
+int AppController::shuffledIndexOf(int original_index) const {
+    if (original_index < 0 || original_index >= (int)shufflePosition.size()) {
+        return -1;
+    }
+    return shufflePosition[original_index];
+}
+
 // --- 歌单管理 ---
 void AppController::createPlaylist(const std::string& name) {
     std::lock_guard<std::mutex> lock(dataMutex);
@@ -275,13 +561,28 @@ void AppController::createPlaylist(const std::string& name) {
 }
 
 void AppController::deletePlaylist(int index) {
+    // 其后的歌单文件要直接改名前移，先暂停后台写入，避免与正在写出的文件交错
+    persistence.pause();
     std::lock_guard<std::mutex> lock(dataMutex);
     if (index >= 0 && index < (int)playlists.size()) {
-        // 删除对应的文件
-        deletePlaylistFile(index);
+        auto removed = playlists[index];
+        unloadedPlaylists.erase(std::remove_if(unloadedPlaylists.begin(), unloadedPlaylists.end(),
+                                               [&](const UnloadedPlaylist& entry) { return entry.playlist == removed; }),
+                                unloadedPlaylists.end());
+        journals.erase(removed.get());
         
-        // 从内存中删除
+        // 从内存中删除，其后的歌单文件整体前移一位；尚未读入的歌单不必读入
+        int old_size = (int)playlists.size();
         playlists.erase(playlists.begin() + index);
+        shiftPlaylistFiles(index, old_size);
+        for (auto& entry : unloadedPlaylists) {
+            if (entry.fileIndex > index) entry.fileIndex--;
+        }
+        ++playlistFilesGeneration;
+        // 已登记但尚未写出的日志仍按原来的位置登记，按新位置重新登记
+        for (int i = index; i < old_size; ++i) {
+            schedulePlaylistSync(i);
+        }
         
         // 更新当前播放索引
         if (currentPlaylistIndex == index) {
@@ -294,38 +595,101 @@ void AppController::deletePlaylist(int index) {
         // 保存配置（更新元信息）
         saveConfig();
     }
+    persistence.resume();
+}
+
+void AppController::shiftPlaylistFiles(int index, int old_size) {
+    auto files_at = [this](int i) {
+        return std::vector<fs::path>{getPlaylistFilePath(i, true), getPlaylistFilePath(i, false), getJournalFilePath(i)};
+    };
+    std::error_code ec;
+    for (const auto& file : files_at(index)) {
+        fs::remove(file, ec);
+    }
+    for (int i = index + 1; i < old_size; ++i) {
+        std::vector<fs::path> from = files_at(i);
+        std::vector<fs::path> to = files_at(i - 1);
+        for (size_t k = 0; k < from.size(); ++k) {
+            if (fs::exists(from[k], ec)) fs::rename(from[k], to[k], ec);
+        }
+    }
+    PersistenceWriter::syncDirectory(getJournalFilePath(index));
 }
 
 void AppController::renamePlaylist(int index, const std::string& new_name) {
     std::lock_guard<std::mutex> lock(dataMutex);
     if (index >= 0 && index < (int)playlists.size()) {
+        ensurePlaylistLoaded(index);
         playlists[index]->name = new_name;
-        savePlaylist(index);
+        PlaylistJournal::recordRename(*playlists[index], journalBuffer(index));
+        saveJournal(index);
     }
 }
 
 void AppController::addSongsFromDirectory(int playlist_index, const std::string& dir_path) {
-    std::lock_guard<std::mutex> lock(dataMutex);
-    if (playlist_index >= 0 && playlist_index < (int)playlists.size()) {
-        std::vector<std::string> songs;
-        scanDirectoryForSongs(dir_path, songs);
-        for (const auto& song_path : songs) {
-            playlists[playlist_index]->addSong(song_path);
-        }
-        savePlaylist(playlist_index);
+    std::shared_ptr<Playlist> target;
+    {
+        std::lock_guard<std::mutex> lock(dataMutex);
+        if (playlist_index < 0 || playlist_index >= (int)playlists.size()) return;
+        target = playlists[playlist_index];
     }
+
+    // 扫描和读取标签在后台线程中进行，不持有 dataMutex，界面和播放线程不受影响；
+    // 按歌单对象而不是位置合并，导入期间删除了前面的歌单也能找到它
+    pendingImports++;
+    std::thread previous = std::move(importThread);
+    importThread = std::thread([this, target, dir_path, previous = std::move(previous)]() mutable {
+        if (previous.joinable()) previous.join();
+        if (importProgress.cancelled) {
+            pendingImports--;
+            return;
+        }
+        importProgress.found = 0;
+        importProgress.read = 0;
+
+        ScanStats stats;
+        LibraryScanner scanner;
+        std::vector<SongEntry> songs = scanner.scan(dir_path, &stats, &importProgress);
+        if (importProgress.cancelled) {
+            pendingImports--;
+            return;
+        }
+
+        // 一次性合并到歌单，日志只记录实际加入的歌曲（已在歌单中的被跳过）
+        std::lock_guard<std::mutex> lock(dataMutex);
+        lastScanStats = stats;
+        auto it = std::find(playlists.begin(), playlists.end(), target);
+        if (it != playlists.end()) {
+            int index = (int)(it - playlists.begin());
+            ensurePlaylistLoaded(index);
+            size_t added = target->addSongs(songs);
+            if (added > 0) {
+                const auto& all = target->getSongs();
+                PlaylistJournal::recordAdd(*target, &all[all.size() - added], added, journalBuffer(index));
+                saveJournal(index);
+            }
+        }
+        TagCache::instance().save();
+        std::vector<std::string> paths;
+        paths.reserve(songs.size());
+        for (const auto& song : songs) paths.push_back(song.path);
+        loudness.enqueue(paths);
+        pendingImports--;
+    });
 }
 
 void AppController::addCurrentSongToPlaylist(int playlist_index) {
     std::lock_guard<std::mutex> lock(dataMutex);
     if (playlist_index >= 0 && playlist_index < (int)playlists.size()) {
+        ensurePlaylistLoaded(playlist_index);
         auto& playlist = playlists[playlist_index];
         std::string current_path = player.getCurrentFilePath();
         if (!current_path.empty()) {
             // 查重：如果歌曲已经在歌单中，不重复添加
             if (!playlist->containsSong(current_path)) {
                 playlist->addSong(current_path);
-                savePlaylist(playlist_index);
+                PlaylistJournal::recordAdd(*playlist, &playlist->getSongs().back(), 1, journalBuffer(playlist_index));
+                saveJournal(playlist_index);
             }
         }
     }
@@ -334,11 +698,13 @@ void AppController::addCurrentSongToPlaylist(int playlist_index) {
 void AppController::addSongToPlaylist(int playlist_index, const std::string& song_path) {
     std::lock_guard<std::mutex> lock(dataMutex);
     if (playlist_index >= 0 && playlist_index < (int)playlists.size()) {
+        ensurePlaylistLoaded(playlist_index);
         auto& playlist = playlists[playlist_index];
         // 查重：如果歌曲已经在歌单中，不重复添加
         if (!playlist->containsSong(song_path)) {
             playlist->addSong(song_path);
-            savePlaylist(playlist_index);
+            PlaylistJournal::recordAdd(*playlist, &playlist->getSongs().back(), 1, journalBuffer(playlist_index));
+            saveJournal(playlist_index);
         }
     }
 }
@@ -346,8 +712,11 @@ void AppController::addSongToPlaylist(int playlist_index, const std::string& son
 void AppController::removeSongFromPlaylist(int playlist_index, int song_index) {
     std::lock_guard<std::mutex> lock(dataMutex);
     if (playlist_index >= 0 && playlist_index < (int)playlists.size()) {
+        ensurePlaylistLoaded(playlist_index);
         auto& playlist = playlists[playlist_index];
+        if (song_index < 0 || song_index >= (int)playlist->size()) return;
         playlist->removeSong(song_index);
+        PlaylistJournal::recordRemove(*playlist, song_index, journalBuffer(playlist_index));
         if (currentPlaylistIndex == playlist_index) {
             if (song_index == currentSongIndex) {
                 // 删除的是当前播放的歌曲
@@ -361,28 +730,29 @@ void AppController::removeSongFromPlaylist(int playlist_index, int song_index) {
                 currentSongIndex--;
             }
         }
-        savePlaylist(playlist_index);
+        saveJournal(playlist_index);
     }
 }
 
 void AppController::sortPlaylist(int playlist_index, SortBy by, SortOrder order) {
     std::lock_guard<std::mutex> lock(dataMutex);
     if (playlist_index >= 0 && playlist_index < (int)playlists.size()) {
+        ensurePlaylistLoaded(playlist_index);
         auto& playlist = playlists[playlist_index];
         std::string current_song = playlist->empty() ? "" : playlist->getSongs()[currentSongIndex].path;
         
-        playlist->sort(by, order);
+        std::vector<uint32_t> permutation;
+        playlist->sort(by, order, &permutation);
+        PlaylistJournal::recordSort(*playlist, permutation, journalBuffer(playlist_index));
         
         // 更新当前歌曲索引
         if (!current_song.empty()) {
-            const auto& songs = playlist->getSongs();
-            auto it = std::find_if(songs.begin(), songs.end(),
-                [&current_song](const SongEntry& song) { return song.path == current_song; });
-            if (it != songs.end()) {
-                currentSongIndex = std::distance(songs.begin(), it);
+            int new_index = playlist->indexOf(current_song);
+            if (new_index >= 0) {
+                currentSongIndex = new_index;
             }
         }
-        savePlaylist(playlist_index);
+        saveJournal(playlist_index);
     }
 }
 
@@ -418,16 +788,28 @@ fs::path AppController::getPlaylistsDir() {
     return playlists_dir;
 }
 
-fs::path AppController::getPlaylistFilePath(int index) {
-    if (index < 0 || index >= (int)playlists.size()) {
-        return fs::path();
-    }
-    std::string filename = "playlist_" + std::to_string(index) + ".json";
+fs::path AppController::getPlaylistFilePath(int index, bool binary) {
+    std::string filename = "playlist_" + std::to_string(index) +
+                           (binary ? PlaylistFile::kBinaryExtension : PlaylistFile::kJsonExtension);
     return getPlaylistsDir() / filename;
 }
 
+fs::path AppController::getJournalFilePath(int index) {
+    return getPlaylistsDir() / ("playlist_" + std::to_string(index) + PlaylistJournal::kExtension);
+}
+
 // --- 配置持久化 ---
 void AppController::saveConfig() {
+    persistence.markDirty("config", [this](PersistTask& task) {
+        std::lock_guard<std::mutex> lock(dataMutex);
+        task.path = getConfigFilePath();
+        auto snapshot = std::make_shared<json>(buildConfigJson());
+        task.serialize = [snapshot]() { return snapshot->dump(4); };
+        return true;
+    });
+}
+
+json AppController::buildConfigJson() {
     json j;
     // 保存播放模式
     std::string mode_str;
@@ -446,6 +828,57 @@ void AppController::saveConfig() {
     j["current_playlist_index"] = currentPlaylistIndex;
     j["current_song_index"] = currentSongIndex;
     j["volume"] = player.getVolume();
+    j["crossfade_seconds"] = player.getCrossfadeSeconds();
+    j["playlist_format"] = binaryPlaylists ? "binary" : "json";
+    switch (replayGainMode.load()) {
+        case ReplayGainMode::OFF:
+            j["replay_gain"] = "off";
+            break;
+        case ReplayGainMode::TRACK:
+            j["replay_gain"] = "track";
+            break;
+        case ReplayGainMode::ALBUM:
+            j["replay_gain"] = "album";
+            break;
+    }
+    
+    // 均衡器及其预设
+    json equalizer;
+    equalizer["enabled"] = eqEnabled;
+    if (eqPresetIndex >= 0 && eqPresetIndex < (int)eqPresets.size()) {
+        equalizer["preset"] = eqPresets[eqPresetIndex].name;
+    }
+    json presets = json::array();
+    for (const auto& preset : eqPresets) {
+        json pj;
+        pj["name"] = preset.name;
+        pj["preamp"] = preset.preamp;
+        json bands = json::array();
+        for (const auto& band : preset.bands) {
+            json bj;
+            bj["type"] = EqPreset::typeName(band.type);
+            bj["freq"] = band.frequency;
+            bj["gain"] = band.gain;
+            bj["q"] = band.q;
+            bands.push_back(bj);
+        }
+        pj["bands"] = bands;
+        presets.push_back(pj);
+    }
+    equalizer["presets"] = presets;
+    j["equalizer"] = equalizer;
+    
+    // 输出设备参数
+    const AudioDeviceConfig& device = player.getDeviceConfig();
+    json audio_device;
+    if (device.sampleRate == 0) {
+        audio_device["sample_rate"] = "auto";
+    } else {
+        audio_device["sample_rate"] = device.sampleRate;
+    }
+    audio_device["format"] = MusicPlayer::formatName(device.format);
+    audio_device["buffer_frames"] = device.bufferFrames;
+    j["audio_device"] = audio_device;
     
     // 只保存歌单的元信息（名称、索引映射）
     json playlists_meta = json::array();
@@ -458,9 +891,7 @@ void AppController::saveConfig() {
         playlists_meta.push_back(meta);
     }
     j["playlists_meta"] = playlists_meta;
-    
-    std::ofstream o(getConfigFilePath());
-    if (o.is_open()) o << j.dump(4);
+    return j;
 }
 
 void AppController::loadConfig() {
@@ -488,6 +919,71 @@ void AppController::loadConfig() {
         if (saved_volume > 100) saved_volume = 100;
         player.setVolume(saved_volume);
         
+        // 加载淡入淡出时长（默认关闭）
+        player.setCrossfadeSeconds(j.value("crossfade_seconds", 0));
+        binaryPlaylists = j.value("playlist_format", "json") == "binary";
+        
+        // 加载响度均衡模式（默认按单曲均衡）
+        std::string gain_str = j.value("replay_gain", "track");
+        if (gain_str == "off") {
+            replayGainMode = ReplayGainMode::OFF;
+        } else if (gain_str == "album") {
+            replayGainMode = ReplayGainMode::ALBUM;
+        } else {
+            replayGainMode = ReplayGainMode::TRACK;
+        }
+        
+        // 加载均衡器；没有保存预设时使用内置预设
+        if (j.contains("equalizer") && j["equalizer"].is_object()) {
+            const json& e = j["equalizer"];
+            eqEnabled = e.value("enabled", false);
+            if (e.contains("presets") && e["presets"].is_array()) {
+                std::vector<EqPreset> presets;
+                for (const auto& pj : e["presets"]) {
+                    if (!pj.is_object()) continue;
+                    EqPreset preset;
+                    preset.name = pj.value("name", "");
+                    preset.preamp = pj.value("preamp", 0.0);
+                    if (pj.contains("bands") && pj["bands"].is_array()) {
+                        for (const auto& bj : pj["bands"]) {
+                            if (!bj.is_object()) continue;
+                            EqBand band;
+                            band.type = EqPreset::parseType(bj.value("type", "peak"));
+                            band.frequency = bj.value("freq", band.frequency);
+                            band.gain = bj.value("gain", band.gain);
+                            band.q = bj.value("q", band.q);
+                            preset.bands.push_back(band);
+                        }
+                    }
+                    if (!preset.name.empty()) presets.push_back(preset);
+                }
+                if (!presets.empty()) eqPresets = presets;
+            }
+            std::string preset_name = e.value("preset", "");
+            for (size_t k = 0; k < eqPresets.size(); ++k) {
+                if (eqPresets[k].name == preset_name) {
+                    eqPresetIndex = (int)k;
+                    break;
+                }
+            }
+        }
+        
+        // 加载输出设备参数，sample_rate 为 "auto" 时按歌曲原始采样率输出
+        if (j.contains("audio_device") && j["audio_device"].is_object()) {
+            const json& d = j["audio_device"];
+            AudioDeviceConfig device;
+            if (d.contains("sample_rate")) {
+                if (d["sample_rate"].is_number_integer()) {
+                    device.sampleRate = d["sample_rate"].get<int>();
+                } else if (d["sample_rate"].is_string() && d["sample_rate"].get<std::string>() == "auto") {
+                    device.sampleRate = 0;
+                }
+            }
+            device.format = MusicPlayer::parseFormat(d.value("format", "s16"));
+            device.bufferFrames = d.value("buffer_frames", device.bufferFrames);
+            player.configureDevice(device);
+        }
+        
         // 注意：这里不加载歌单内容，只加载元信息
         // 歌单内容在 loadPlaylists() 中单独加载
     } catch (...) {}
@@ -513,19 +1009,9 @@ void AppController::loadPlaylists() {
                 playlist->created_time = meta.value("created_time", 0);
                 playlist->modified_time = meta.value("modified_time", 0);
                 
-                // 尝试从单独的文件加载歌曲
-                fs::path playlist_file = getPlaylistsDir() / ("playlist_" + std::to_string(index) + ".json");
-                if (fs::exists(playlist_file)) {
-                    std::ifstream pf(playlist_file);
-                    try {
-                        json playlist_json = json::parse(pf);
-                        *playlist = Playlist::fromJson(playlist_json);
-                    } catch (...) {
-                        // 如果文件损坏，至少保留歌单名称
-                    }
-                }
-                
+                // 歌曲列表由 loadPlaylistBodies 在后台从单独的文件读入
                 playlists.push_back(playlist);
+                unloadedPlaylists.push_back({playlist, index});
             }
         }
     } catch (...) {}
@@ -535,31 +1021,78 @@ void AppController::savePlaylist(int index) {
     if (index < 0 || index >= (int)playlists.size()) {
         return;
     }
-    
-    fs::path playlist_file = getPlaylistsDir() / ("playlist_" + std::to_string(index) + ".json");
-    std::ofstream o(playlist_file);
-    if (o.is_open()) {
-        o << playlists[index]->toJson().dump(4);
-    }
+    markPlaylistDirty(index);
     
     // 更新配置文件中的元信息
     saveConfig();
 }
 
-void AppController::deletePlaylistFile(int index) {
-    fs::path playlist_file = getPlaylistsDir() / ("playlist_" + std::to_string(index) + ".json");
-    if (fs::exists(playlist_file)) {
-        fs::remove(playlist_file);
+std::string& AppController::journalBuffer(int index) {
+    return journals[playlists[index].get()].pending;
+}
+
+void AppController::saveJournal(int index) {
+    if (index < 0 || index >= (int)playlists.size()) {
+        return;
     }
-    
-    // 重命名后面的歌单文件
-    for (int i = index + 1; i < (int)playlists.size() + 1; ++i) {
-        fs::path old_file = getPlaylistsDir() / ("playlist_" + std::to_string(i) + ".json");
-        fs::path new_file = getPlaylistsDir() / ("playlist_" + std::to_string(i - 1) + ".json");
-        if (fs::exists(old_file)) {
-            fs::rename(old_file, new_file);
-        }
+    schedulePlaylistSync(index);
+    saveConfig();
+}
+
+void AppController::markPlaylistDirty(int index) {
+    if (index < (int)playlists.size()) {
+        journals[playlists[index].get()].rewrite = true;
     }
+    schedulePlaylistSync(index);
+}
+
+void AppController::schedulePlaylistSync(int index) {
+    // 按文件位置登记：写出时该位置有歌单就同步它当时的内容，没有就删除文件，
+    // 因此删除歌单后文件前移只需重新登记受影响的位置
+    persistence.markDirty("playlist:" + std::to_string(index), [this, index](PersistTask& task) {
+        std::lock_guard<std::mutex> lock(dataMutex);
+        fs::path journal = getJournalFilePath(index);
+        task.path = getPlaylistFilePath(index, binaryPlaylists);
+        task.obsolete = {getPlaylistFilePath(index, !binaryPlaylists), journal};
+        if (index >= (int)playlists.size()) return true;
+
+        // 尚未读入的歌单没有修改过（修改前总会先读入），文件无需更新
+        auto playlist_ptr = playlists[index];
+        if (std::any_of(unloadedPlaylists.begin(), unloadedPlaylists.end(),
+                        [&](const UnloadedPlaylist& entry) { return entry.playlist == playlist_ptr; })) {
+            return false;
+        }
+        const Playlist* playlist = playlist_ptr.get();
+        JournalState& state = journals[playlist];
+        // 写入失败时磁盘上仍是旧的歌单文件和日志（追加失败时日志还可能缺少记录或留下不完整的记录），
+        // 而内存中的记录已经取出：标记为整体重写，persistence 按退避间隔重试时写出完整的歌单
+        task.failed = [this, owner = playlist_ptr]() {
+            std::lock_guard<std::mutex> lock(dataMutex);
+            if (std::find(playlists.begin(), playlists.end(), owner) != playlists.end()) {
+                journals[owner.get()].rewrite = true;
+            }
+        };
+        if (!state.rewrite && state.onDisk + state.pending.size() <= PlaylistJournal::kCompactBytes) {
+            // 只追加这段时间的修改记录
+            if (state.pending.empty()) return false;
+            auto records = std::make_shared<std::string>(std::move(state.pending));
+            state.pending.clear();
+            state.onDisk += records->size();
+            task.path = journal;
+            task.append = true;
+            task.obsolete.clear();
+            task.serialize = [records]() { return std::move(*records); };
+            return true;
+        }
+
+        // 合并：重写歌单文件（其中记录了已包含的 revision），写完后删除日志。
+        // 快照已包含全部修改，之后的记录追加到新日志；写入失败时由 task.failed 恢复整体重写
+        state = JournalState();
+        auto snapshot = std::make_shared<Playlist>(*playlist);
+        fs::path path = task.path;
+        task.serialize = [snapshot, path]() { return PlaylistFile::serialize(*snapshot, path); };
+        return true;
+    });
 }
 
 // --- 乱序播放相关函数实现 ---
@@ -612,24 +1145,15 @@ const SongEntry& AppController::getSongAt(int index) const {
 
 int AppController::findSongIndexByPath(const std::string& path) const {
     if (currentPlaylistIndex >= 0 && currentPlaylistIndex < (int)playlists.size()) {
-        auto& playlist = playlists[currentPlaylistIndex];
-        const auto& songs = playlist->getSongs();
-        
-        // 首先在原始歌单中查找
-        for (size_t i = 0; i < songs.size(); ++i) {
-            if (songs[i].path == path) {
-                // 找到原始索引，如果需要返回乱序索引
-                if (mode == PlayMode::SHUFFLE && !shuffleOrder.empty()) {
-                    // 在乱序列表中查找这个原始索引
-                    for (size_t j = 0; j < shuffleOrder.size(); ++j) {
-                        if (shuffleOrder[j] == (int)i) {
-                            return j;
-                        }
-                    }
-                }
-                return i;
+        // 哈希索引查原始位置，乱序模式下再经逆映射得到乱序位置
+        int original_index = playlists[currentPlaylistIndex]->indexOf(path);
+        if (original_index >= 0 && mode == PlayMode::SHUFFLE && !shuffleOrder.empty()) {
+            int shuffled_index = shuffledIndexOf(original_index);
+            if (shuffled_index >= 0) {
+                return shuffled_index;
             }
         }
+        return original_index;
     }
     return -1;
 }
@@ -647,6 +1171,45 @@ void AppController::decreaseVolume() {
     saveConfig(); // 保存配置，记住音量设置
 }
 
+void AppController::setReplayGainMode(ReplayGainMode new_mode) {
+    std::lock_guard<std::mutex> lock(dataMutex);
+    replayGainMode = new_mode;
+    saveConfig();
+    // 由播放线程重新计算当前歌曲的增益
+    needGainRefresh = true;
+    wakePlaybackThread();
+}
+
+void AppController::applyEqualizer() {
+    ParametricEq& eq = player.getEqualizer();
+    if (eqPresetIndex >= 0 && eqPresetIndex < (int)eqPresets.size()) {
+        eq.setPreset(eqPresets[eqPresetIndex]);
+    }
+    eq.setEnabled(eqEnabled);
+}
+
+void AppController::setEqualizerEnabled(bool enabled) {
+    std::lock_guard<std::mutex> lock(dataMutex);
+    eqEnabled = enabled;
+    applyEqualizer();
+    saveConfig();
+}
+
+void AppController::selectEqualizerPreset(int index) {
+    std::lock_guard<std::mutex> lock(dataMutex);
+    if (index < 0 || index >= (int)eqPresets.size()) return;
+    eqPresetIndex = index;
+    applyEqualizer();
+    saveConfig();
+}
+
+void AppController::setCrossfadeSeconds(int seconds) {
+    std::lock_guard<std::mutex> lock(dataMutex);
+    player.setCrossfadeSeconds(seconds);
+    saveConfig();
+    wakePlaybackThread(); // 重新计算切换时间
+}
+
 int AppController::getVolume() const {
     std::lock_guard<std::mutex> lock(dataMutex);
     return player.getVolume();
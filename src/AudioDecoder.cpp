@@ -0,0 +1,114 @@
+#include "AudioDecoder.hpp"
+#include "GainStage.hpp"
+#include <cstdio>
+
+namespace {
+const int kDecodeChunkFrames = 4096; // 每次从文件解码的帧数
+}
+
+AudioDecoder::~AudioDecoder() {
+    close();
+}
+
+bool AudioDecoder::open(const std::string& path, int out_rate, int out_channels) {
+    close();
+    file = sf_open(path.c_str(), SFM_READ, &info);
+    if (!file) return false;
+
+    eof = false;
+    if (out_rate <= 0) out_rate = info.samplerate;
+    if (out_channels <= 0) out_channels = info.channels;
+    if (!setOutput(out_rate, out_channels)) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool AudioDecoder::setOutput(int out_rate, int out_channels) {
+    if (!file) return false;
+    if (stream) {
+        SDL_FreeAudioStream(stream);
+        stream = nullptr;
+    }
+    outRate = out_rate;
+    outChannels = out_channels;
+
+    // 格式不一致时才需要重采样/声道转换
+    if (info.samplerate != out_rate || info.channels != out_channels) {
+        stream = SDL_NewAudioStream(AUDIO_F32SYS, info.channels, info.samplerate,
+                                    AUDIO_F32SYS, out_channels, out_rate);
+        if (!stream) return false;
+        scratch.resize(kDecodeChunkFrames * info.channels);
+    }
+    return true;
+}
+
+void AudioDecoder::close() {
+    if (stream) {
+        SDL_FreeAudioStream(stream);
+        stream = nullptr;
+    }
+    if (file) {
+        sf_close(file);
+        file = nullptr;
+    }
+    info = SF_INFO{};
+    eof = true;
+    gain = 1.0f;
+}
+
+int AudioDecoder::read(float* out, int frames) {
+    int got = readFrames(out, frames);
+    if (got > 0 && gain != 1.0f) {
+        GainStage::applyConstant(out, (size_t)got * outChannels, gain);
+    }
+    return got;
+}
+
+int AudioDecoder::readFrames(float* out, int frames) {
+    if (!file || frames <= 0) return 0;
+
+    if (!stream) {
+        // 直接解码到输出缓冲区
+        if (eof) return 0;
+        sf_count_t got = sf_readf_float(file, out, frames);
+        if (got < frames) eof = true;
+        return got > 0 ? (int)got : 0;
+    }
+
+    int bytes_per_frame = outChannels * (int)sizeof(float);
+    int wanted = frames * bytes_per_frame;
+    while (!eof && SDL_AudioStreamAvailable(stream) < wanted) {
+        sf_count_t got = sf_readf_float(file, scratch.data(), kDecodeChunkFrames);
+        if (got > 0) {
+            SDL_AudioStreamPut(stream, scratch.data(), (int)(got * info.channels * sizeof(float)));
+        }
+        if (got < kDecodeChunkFrames) {
+            // 文件结束：取出重采样器中剩余的数据
+            eof = true;
+            SDL_AudioStreamFlush(stream);
+        }
+    }
+    int got_bytes = SDL_AudioStreamGet(stream, out, wanted);
+    return got_bytes > 0 ? got_bytes / bytes_per_frame : 0;
+}
+
+bool AudioDecoder::seek(double seconds) {
+    if (!file) return false;
+    if (seconds < 0) seconds = 0;
+    sf_count_t frame = (sf_count_t)(seconds * info.samplerate);
+    if (sf_seek(file, frame, SEEK_SET) < 0) return false;
+    if (stream) SDL_AudioStreamClear(stream);
+    eof = false;
+    return true;
+}
+
+double AudioDecoder::duration() const {
+    if (!file || info.samplerate <= 0) return 0.0;
+    return (double)info.frames / info.samplerate;
+}
+
+bool AudioDecoder::hasBufferedOutput() const {
+    return stream && SDL_AudioStreamAvailable(stream) > 0;
+}
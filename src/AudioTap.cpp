@@ -0,0 +1,33 @@
+#include "AudioTap.hpp"
+#include <algorithm>
+
+void AudioTap::write(const float* data, size_t frames, int channels) {
+    if (!active.load(std::memory_order_relaxed) || channels <= 0) return;
+
+    // 只保留窗口能容纳的最后一段
+    if (frames > kFrames) {
+        data += (frames - kFrames) * channels;
+        frames = kFrames;
+    }
+    uint64_t pos = writePos.load(std::memory_order_relaxed);
+    int right = channels > 1 ? 1 : 0;
+    for (size_t i = 0; i < frames; ++i) {
+        size_t slot = ((pos + i) & kMask) * kChannels;
+        const float* frame = data + i * channels;
+        samples[slot].store(frame[0], std::memory_order_relaxed);
+        samples[slot + 1].store(frame[right], std::memory_order_relaxed);
+    }
+    writePos.store(pos + frames, std::memory_order_release);
+}
+
+size_t AudioTap::readLatest(float* dest, size_t frames) const {
+    uint64_t end = writePos.load(std::memory_order_acquire);
+    frames = std::min<uint64_t>({frames, kFrames, end});
+    uint64_t start = end - frames;
+    for (size_t i = 0; i < frames; ++i) {
+        size_t slot = ((start + i) & kMask) * kChannels;
+        dest[i * kChannels] = samples[slot].load(std::memory_order_relaxed);
+        dest[i * kChannels + 1] = samples[slot + 1].load(std::memory_order_relaxed);
+    }
+    return frames;
+}
@@ -0,0 +1,94 @@
+#include "DspChain.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+namespace {
+const double kAverageWeight = 0.05; // 滑动平均中新样本的权重
+
+// 处理期间把非规格化数当作 0（FTZ/DAZ），结束后恢复。
+// 均衡器等 IIR 滤波器在静音时状态会衰减到非规格化数，逐样本运算会慢上百倍
+class DenormalGuard {
+public:
+    DenormalGuard() {
+#if defined(__SSE__)
+        saved = _mm_getcsr();
+        _mm_setcsr(saved | 0x8040); // FTZ (bit 15) | DAZ (bit 6)
+#elif defined(__aarch64__)
+        asm volatile("mrs %0, fpcr" : "=r"(saved));
+        asm volatile("msr fpcr, %0" : : "r"(saved | (1ull << 24))); // FZ
+#endif
+    }
+    ~DenormalGuard() {
+#if defined(__SSE__)
+        _mm_setcsr(saved);
+#elif defined(__aarch64__)
+        asm volatile("msr fpcr, %0" : : "r"(saved));
+#endif
+    }
+    DenormalGuard(const DenormalGuard&) = delete;
+    DenormalGuard& operator=(const DenormalGuard&) = delete;
+
+private:
+#if defined(__SSE__)
+    unsigned int saved = 0;
+#elif defined(__aarch64__)
+    uint64_t saved = 0;
+#endif
+};
+}
+
+void DspChain::add(std::unique_ptr<DspStage> stage) {
+    stage->prepare(sampleRate, channels);
+    stages.push_back(std::move(stage));
+}
+
+void DspChain::prepare(int sample_rate, int channel_count) {
+    sampleRate = sample_rate;
+    channels = channel_count;
+    for (auto& stage : stages) {
+        stage->prepare(sample_rate, channel_count);
+    }
+    resetStats();
+}
+
+void DspChain::process(float* data, size_t frames) {
+    if (stages.empty() || frames == 0) return;
+
+    auto start = std::chrono::steady_clock::now();
+    {
+        DenormalGuard guard;
+        for (auto& stage : stages) {
+            if (stage->isEnabled()) stage->process(data, frames);
+        }
+    }
+    double micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+    // 只有音频回调写入，读取方只需要近似值
+    double average = averageMicros.load(std::memory_order_relaxed);
+    average += (micros - average) * kAverageWeight;
+    averageMicros.store(average, std::memory_order_relaxed);
+    if (micros > peakMicros.load(std::memory_order_relaxed)) {
+        peakMicros.store(micros, std::memory_order_relaxed);
+    }
+    double buffer_micros = frames * 1e6 / sampleRate;
+    load.store(average / buffer_micros, std::memory_order_relaxed);
+}
+
+DspStats DspChain::getStats() const {
+    DspStats stats;
+    stats.averageMicros = averageMicros.load(std::memory_order_relaxed);
+    stats.peakMicros = peakMicros.load(std::memory_order_relaxed);
+    stats.load = load.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void DspChain::resetStats() {
+    averageMicros.store(0.0, std::memory_order_relaxed);
+    peakMicros.store(0.0, std::memory_order_relaxed);
+    load.store(0.0, std::memory_order_relaxed);
+}
@@ -0,0 +1,189 @@
+#include "GainStage.hpp"
+#include <SDL2/SDL.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define GAIN_STAGE_X86 1
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define GAIN_STAGE_NEON 1
+#endif
+
+namespace {
+const double kRampSeconds = 0.01; // 增益过渡时长
+
+void applyScalar(float* data, size_t count, float gain, float step) {
+    for (size_t i = 0; i < count; ++i) {
+        data[i] *= gain + (float)i * step;
+    }
+}
+
+#ifdef GAIN_STAGE_X86
+__attribute__((target("sse")))
+void applySSE(float* data, size_t count, float gain, float step) {
+    __m128 g = _mm_setr_ps(gain, gain + step, gain + 2 * step, gain + 3 * step);
+    __m128 inc = _mm_set1_ps(4 * step);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(data + i, _mm_mul_ps(_mm_loadu_ps(data + i), g));
+        g = _mm_add_ps(g, inc);
+    }
+    applyScalar(data + i, count - i, gain + (float)i * step, step);
+}
+
+__attribute__((target("avx2")))
+void applyAVX2(float* data, size_t count, float gain, float step) {
+    __m256 g = _mm256_setr_ps(gain, gain + step, gain + 2 * step, gain + 3 * step,
+                              gain + 4 * step, gain + 5 * step, gain + 6 * step, gain + 7 * step);
+    __m256 inc = _mm256_set1_ps(8 * step);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(data + i, _mm256_mul_ps(_mm256_loadu_ps(data + i), g));
+        g = _mm256_add_ps(g, inc);
+    }
+    applyScalar(data + i, count - i, gain + (float)i * step, step);
+}
+#endif
+
+#ifdef GAIN_STAGE_NEON
+void applyNEON(float* data, size_t count, float gain, float step) {
+    float init[4] = {gain, gain + step, gain + 2 * step, gain + 3 * step};
+    float32x4_t g = vld1q_f32(init);
+    float32x4_t inc = vdupq_n_f32(4 * step);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        vst1q_f32(data + i, vmulq_f32(vld1q_f32(data + i), g));
+        g = vaddq_f32(g, inc);
+    }
+    applyScalar(data + i, count - i, gain + (float)i * step, step);
+}
+#endif
+}
+
+GainStage::GainStage() {
+    std::vector<Kernel> kernels = availableKernels();
+    activeKernel = kernels.back(); // 按从慢到快排列，取最快的
+    apply = kernelFor(activeKernel);
+    reset(44100, 2);
+}
+
+GainStage::KernelFn GainStage::bestKernel() {
+    static const KernelFn fn = kernelFor(availableKernels().back());
+    return fn;
+}
+
+void GainStage::applyConstant(float* data, size_t count, float gain) {
+    bestKernel()(data, count, gain, 0.0f);
+}
+
+void GainStage::reset(int sample_rate, int channel_count) {
+    channels = std::max(1, channel_count);
+    rampSamples = std::max<size_t>(1, (size_t)(sample_rate * kRampSeconds) * channels);
+    // 重置后直接使用目标增益
+    currentGain = rampTarget = targetGain.load(std::memory_order_relaxed);
+    rampStep = 0.0f;
+    rampRemaining = 0;
+}
+
+void GainStage::process(float* data, size_t frames) {
+    size_t samples = frames * channels;
+
+    // 目标改变：从当前增益开始新的过渡
+    float target = targetGain.load(std::memory_order_relaxed);
+    if (target != rampTarget) {
+        rampTarget = target;
+        rampStep = (target - currentGain) / rampSamples;
+        rampRemaining = rampSamples;
+    }
+
+    size_t done = 0;
+    if (rampRemaining > 0) {
+        done = std::min(rampRemaining, samples);
+        apply(data, done, currentGain, rampStep);
+        rampRemaining -= done;
+        currentGain = (rampRemaining == 0) ? rampTarget : currentGain + rampStep * done;
+    }
+    if (done < samples && currentGain != 1.0f) {
+        apply(data + done, samples - done, currentGain, 0.0f);
+    }
+}
+
+const char* GainStage::kernelName(Kernel kernel) {
+    switch (kernel) {
+        case Kernel::SSE: return "SSE";
+        case Kernel::AVX2: return "AVX2";
+        case Kernel::NEON: return "NEON";
+        default: return "Scalar";
+    }
+}
+
+std::vector<GainStage::Kernel> GainStage::availableKernels() {
+    std::vector<Kernel> kernels = {Kernel::Scalar};
+#ifdef GAIN_STAGE_X86
+    if (SDL_HasSSE()) kernels.push_back(Kernel::SSE);
+    if (SDL_HasAVX2()) kernels.push_back(Kernel::AVX2);
+#endif
+#ifdef GAIN_STAGE_NEON
+    if (SDL_HasNEON()) kernels.push_back(Kernel::NEON);
+#endif
+    return kernels;
+}
+
+GainStage::KernelFn GainStage::kernelFor(Kernel kernel) {
+    switch (kernel) {
+#ifdef GAIN_STAGE_X86
+        case Kernel::SSE: return &applySSE;
+        case Kernel::AVX2: return &applyAVX2;
+#endif
+#ifdef GAIN_STAGE_NEON
+        case Kernel::NEON: return &applyNEON;
+#endif
+        default: return &applyScalar;
+    }
+}
+
+void GainStage::benchmark(std::ostream& out) {
+    // 模拟 2048 帧立体声缓冲区，一半时间处于增益过渡中
+    const size_t samples = 2048 * 2;
+    const int iterations = 20000;
+    std::vector<float> input(samples);
+    for (size_t i = 0; i < samples; ++i) {
+        input[i] = (float)std::sin(i * 0.01);
+    }
+
+    std::vector<float> reference = input;
+    applyScalar(reference.data(), samples, 0.5f, 1e-5f);
+
+    double scalar_ns = 0.0;
+    char line[160];
+    out << "增益内核测试: " << iterations << " 次 x " << samples << " 个样本\n";
+    for (Kernel kernel : availableKernels()) {
+        KernelFn fn = kernelFor(kernel);
+        std::vector<float> data = input;
+        auto start = std::chrono::steady_clock::now();
+        for (int it = 0; it < iterations; ++it) {
+            float step = (it & 1) ? 1e-7f : 0.0f;
+            fn(data.data(), samples, 1.0f, step);
+        }
+        auto end = std::chrono::steady_clock::now();
+        double ns = std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+        if (kernel == Kernel::Scalar) scalar_ns = ns;
+
+        // 与标量实现比较结果误差
+        std::vector<float> check = input;
+        fn(check.data(), samples, 0.5f, 1e-5f);
+        double max_error = 0.0;
+        for (size_t i = 0; i < samples; ++i) {
+            max_error = std::max(max_error, (double)std::fabs(check[i] - reference[i]));
+        }
+
+        snprintf(line, sizeof(line), "  %-6s %8.1f ns/缓冲区  %6.2f 样本/ns  加速 %.2fx  最大误差 %.2e\n",
+                 kernelName(kernel), ns, samples / ns, scalar_ns > 0 ? scalar_ns / ns : 1.0, max_error);
+        out << line;
+    }
+}
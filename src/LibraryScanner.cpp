@@ -0,0 +1,82 @@
+#include "LibraryScanner.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+LibraryScanner::LibraryScanner(unsigned int threads) : threadCount(threads) {
+    if (threadCount == 0) {
+        threadCount = std::thread::hardware_concurrency();
+        if (threadCount == 0) threadCount = 4; // 无法获取核心数时的保守值
+    }
+}
+
+bool LibraryScanner::isSupportedAudioFile(const fs::path& path) {
+    std::string ext = path.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    return ext == ".mp3" || ext == ".flac";
+}
+
+std::vector<std::string> LibraryScanner::collectAudioFiles(const std::string& dir_path, ScanProgress* progress) {
+    std::vector<std::string> result;
+    std::error_code ec;
+    fs::path root = dir_path;
+    if (!fs::is_directory(root, ec)) return result;
+
+    // 跳过无权限的子目录，单个条目出错时继续遍历
+    auto options = fs::directory_options::skip_permission_denied;
+    for (fs::recursive_directory_iterator it(root, options, ec), end; !ec && it != end; it.increment(ec)) {
+        if (progress && progress->cancelled) break;
+        std::error_code entry_ec;
+        if (!it->is_regular_file(entry_ec) || entry_ec) continue;
+        if (isSupportedAudioFile(it->path())) {
+            result.push_back(it->path().string());
+            if (progress) progress->found++;
+        }
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+std::vector<SongEntry> LibraryScanner::readMetadata(const std::vector<std::string>& paths, ScanStats* stats,
+                                                    ScanProgress* progress) {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<SongEntry> result(paths.size());
+
+    // 工作线程通过原子计数器领取任务，每个文件只由一个线程写入对应槽位
+    std::atomic<size_t> next{0};
+    auto worker = [&]() {
+        for (size_t i = next++; i < paths.size(); i = next++) {
+            if (progress && progress->cancelled) break;
+            result[i].path = paths[i];
+            result[i].loadMetadata();
+            if (progress) progress->read++;
+        }
+    };
+
+    unsigned int workers = std::min<size_t>(threadCount, paths.size());
+    std::vector<std::thread> pool;
+    for (unsigned int t = 1; t < workers; ++t) {
+        pool.emplace_back(worker);
+    }
+    worker(); // 调用线程也参与工作
+    for (auto& t : pool) t.join();
+
+    if (stats) {
+        stats->files = paths.size();
+        stats->threads = std::max(1u, workers);
+        stats->seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    return result;
+}
+
+std::vector<SongEntry> LibraryScanner::scan(const std::string& dir_path, ScanStats* stats,
+                                            ScanProgress* progress) {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<SongEntry> songs = readMetadata(collectAudioFiles(dir_path, progress), stats, progress);
+    if (stats) {
+        // 统计包含目录遍历的时间
+        stats->seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    return songs;
+}
@@ -0,0 +1,513 @@
+#include "LoudnessAnalyzer.hpp"
+#include "AudioDecoder.hpp"
+#include "PersistenceWriter.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+namespace {
+const double kPi = 3.14159265358979323846;
+const double kAbsoluteGate = -70.0;  // 绝对门限（LUFS）
+const double kRelativeGate = -10.0;  // 相对门限（LU）
+const double kMaxGain = 20.0;        // 增益上下限（dB），避免对近乎静音的文件过度提升
+const int kReadFrames = 4096;
+
+double powerToLufs(double power) {
+    return -0.691 + 10.0 * std::log10(power);
+}
+
+double lufsToPower(double lufs) {
+    return std::pow(10.0, (lufs + 0.691) / 10.0);
+}
+
+// 直接 II 型转置结构的二阶滤波器
+struct Biquad {
+    double b0 = 1, b1 = 0, b2 = 0, a1 = 0, a2 = 0;
+    double z1 = 0, z2 = 0;
+
+    double process(double x) {
+        double y = b0 * x + z1;
+        z1 = b1 * x - a1 * y + z2;
+        z2 = b2 * x - a2 * y;
+        return y;
+    }
+};
+
+// ITU-R BS.1770 K 计权：高架滤波 + 高通滤波，系数按采样率计算
+void makeKWeighting(int rate, Biquad& shelf, Biquad& highpass) {
+    double f0 = 1681.974450955533;
+    double gain_db = 3.999843853973347;
+    double q = 0.7071752369554196;
+    double k = std::tan(kPi * f0 / rate);
+    double vh = std::pow(10.0, gain_db / 20.0);
+    double vb = std::pow(vh, 0.4996667741545416);
+    double a0 = 1.0 + k / q + k * k;
+    shelf.b0 = (vh + vb * k / q + k * k) / a0;
+    shelf.b1 = 2.0 * (k * k - vh) / a0;
+    shelf.b2 = (vh - vb * k / q + k * k) / a0;
+    shelf.a1 = 2.0 * (k * k - 1.0) / a0;
+    shelf.a2 = (1.0 - k / q + k * k) / a0;
+
+    f0 = 38.13547087602444;
+    q = 0.5003270373238773;
+    k = std::tan(kPi * f0 / rate);
+    a0 = 1.0 + k / q + k * k;
+    highpass.b0 = 1.0;
+    highpass.b1 = -2.0;
+    highpass.b2 = 1.0;
+    highpass.a1 = 2.0 * (k * k - 1.0) / a0;
+    highpass.a2 = (1.0 - k / q + k * k) / a0;
+}
+
+// 声道权重：5.1 布局的 LFE 不计入，环绕声道 +1.5 dB
+double channelWeight(int channel, int channels) {
+    if (channels == 6) {
+        if (channel == 3) return 0.0;
+        if (channel >= 4) return 1.41;
+    }
+    return 1.0;
+}
+
+// 4 倍过采样的真峰值测量（多相加窗 sinc 插值）
+class TruePeakMeter {
+public:
+    static constexpr int kPhases = 4;
+    static constexpr int kTaps = 12; // 每相抽头数
+
+    TruePeakMeter() {
+        const int n = kPhases * kTaps;
+        double center = (n - 1) / 2.0;
+        for (int p = 0; p < kPhases; ++p) {
+            for (int t = 0; t < kTaps; ++t) {
+                int i = t * kPhases + p;
+                double x = (i - center) / kPhases;
+                double sinc = (x == 0.0) ? 1.0 : std::sin(kPi * x) / (kPi * x);
+                double window = 0.5 - 0.5 * std::cos(2.0 * kPi * (i + 0.5) / n);
+                coeffs[p][t] = sinc * window;
+            }
+        }
+    }
+
+    // 输入一个样本，返回插值后 4 个点中的最大绝对值
+    double process(double x) {
+        pos = (pos + kTaps - 1) % kTaps;
+        history[pos] = x;
+        double peak = std::fabs(x);
+        for (int p = 0; p < kPhases; ++p) {
+            double y = 0.0;
+            for (int t = 0; t < kTaps; ++t) {
+                y += coeffs[p][t] * history[(pos + t) % kTaps];
+            }
+            peak = std::max(peak, std::fabs(y));
+        }
+        return peak;
+    }
+
+private:
+    double coeffs[kPhases][kTaps];
+    double history[kTaps] = {};
+    int pos = 0;
+};
+
+std::int64_t fileMtime(const fs::path& p, std::error_code& ec) {
+    return (std::int64_t)fs::last_write_time(p, ec).time_since_epoch().count();
+}
+}
+
+// --- 单文件分析 ---
+bool LoudnessAnalyzer::measure(const std::string& path, LoudnessInfo& out) {
+    AudioDecoder decoder;
+    if (!decoder.open(path, 0, 0)) return false; // 按原始格式解码，不重采样
+    int rate = decoder.sourceRate();
+    int channels = decoder.sourceChannels();
+    if (rate <= 0 || channels <= 0) return false;
+
+    std::vector<Biquad> shelf(channels), highpass(channels);
+    for (int c = 0; c < channels; ++c) makeKWeighting(rate, shelf[c], highpass[c]);
+    std::vector<TruePeakMeter> peak_meters(channels);
+    std::vector<double> weights(channels);
+    for (int c = 0; c < channels; ++c) weights[c] = channelWeight(c, channels);
+
+    // 400ms 响度块，每 100ms 一步（75% 重叠）：先累计 100ms 子块的加权功率
+    const long sub_block = std::max(1, rate / 10);
+    long sub_pos = 0;
+    double sub_energy = 0.0;
+    double recent[4] = {};
+    int recent_count = 0;
+    std::vector<double> blocks;
+    double true_peak = 0.0;
+
+    std::vector<float> buffer((size_t)kReadFrames * channels);
+    int got;
+    while ((got = decoder.read(buffer.data(), kReadFrames)) > 0) {
+        for (int i = 0; i < got; ++i) {
+            const float* frame = &buffer[(size_t)i * channels];
+            for (int c = 0; c < channels; ++c) {
+                double x = frame[c];
+                true_peak = std::max(true_peak, peak_meters[c].process(x));
+                if (weights[c] == 0.0) continue;
+                double y = highpass[c].process(shelf[c].process(x));
+                sub_energy += weights[c] * y * y;
+            }
+            if (++sub_pos == sub_block) {
+                recent[recent_count % 4] = sub_energy / sub_block;
+                ++recent_count;
+                if (recent_count >= 4) {
+                    blocks.push_back((recent[0] + recent[1] + recent[2] + recent[3]) / 4.0);
+                }
+                sub_pos = 0;
+                sub_energy = 0.0;
+            }
+        }
+    }
+
+    // 门限：先去掉低于 -70 LUFS 的块，再去掉低于平均响度 10 LU 的块
+    double abs_threshold = lufsToPower(kAbsoluteGate);
+    double sum = 0.0;
+    long count = 0;
+    for (double p : blocks) {
+        if (p > abs_threshold) { sum += p; ++count; }
+    }
+    double integrated = kAbsoluteGate;
+    double gated_power = 0.0;
+    long gated_blocks = 0;
+    if (count > 0) {
+        double rel_threshold = lufsToPower(powerToLufs(sum / count) + kRelativeGate);
+        double threshold = std::max(abs_threshold, rel_threshold);
+        sum = 0.0;
+        for (double p : blocks) {
+            if (p > threshold) { sum += p; ++gated_blocks; }
+        }
+        if (gated_blocks > 0) {
+            gated_power = sum / gated_blocks;
+            integrated = powerToLufs(gated_power);
+        }
+    }
+
+    out = LoudnessInfo();
+    out.integrated = integrated;
+    out.truePeak = true_peak;
+    out.trackGain = std::max(-kMaxGain, std::min(kMaxGain, kReferenceLufs - integrated));
+    out.gatedPower = gated_power;
+    out.gatedBlocks = gated_blocks;
+    return true;
+}
+
+// --- 后台分析器 ---
+LoudnessAnalyzer::LoudnessAnalyzer(unsigned int threads) : threadCount(threads) {
+    if (threadCount == 0) {
+        threadCount = std::thread::hardware_concurrency();
+        if (threadCount == 0) threadCount = 4; // 无法获取核心数时的保守值
+    }
+}
+
+LoudnessAnalyzer::~LoudnessAnalyzer() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    queueCv.notify_all();
+    for (auto& t : workers) t.join();
+    save();
+}
+
+void LoudnessAnalyzer::startWorkers() {
+    // 调用者需持有 mutex；第一次有任务时才创建线程
+    if (!workers.empty()) return;
+    for (unsigned int i = 0; i < threadCount; ++i) {
+        workers.emplace_back(&LoudnessAnalyzer::worker, this);
+    }
+}
+
+void LoudnessAnalyzer::enqueue(const std::vector<std::string>& paths) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (queue.empty() && busyWorkers == 0) {
+            // 新一轮分析
+            batchStart = batchEnd = std::chrono::steady_clock::now();
+            batchProcessed = 0;
+            batchAnalyzed = 0;
+        }
+        for (const auto& path : paths) {
+            if (queued.insert(path).second) queue.push_back(path);
+        }
+        if (queue.empty()) return;
+        startWorkers();
+    }
+    queueCv.notify_all();
+}
+
+void LoudnessAnalyzer::prioritize(const std::string& path) {
+    if (path.empty()) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (queue.empty() && busyWorkers == 0) {
+            batchStart = batchEnd = std::chrono::steady_clock::now();
+            batchProcessed = 0;
+            batchAnalyzed = 0;
+        }
+        if (!queued.insert(path).second) {
+            auto it = std::find(queue.begin(), queue.end(), path);
+            if (it == queue.end()) return; // 正在分析中
+            queue.erase(it);
+        }
+        queue.push_front(path);
+        startWorkers();
+    }
+    queueCv.notify_one();
+}
+
+void LoudnessAnalyzer::worker() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        queueCv.wait(lock, [this]() { return stopping || (cacheLoaded && !queue.empty()); });
+        if (stopping) return;
+
+        std::string path = std::move(queue.front());
+        queue.pop_front();
+        ++busyWorkers;
+        lock.unlock();
+
+        process(path);
+
+        lock.lock();
+        queued.erase(path);
+        --busyWorkers;
+        ++batchProcessed;
+        batchEnd = std::chrono::steady_clock::now();
+        if (queue.empty() && busyWorkers == 0 && dirty) {
+            // 一轮分析结束：写回缓存
+            lock.unlock();
+            save();
+            lock.lock();
+        }
+    }
+}
+
+void LoudnessAnalyzer::process(const std::string& path) {
+    std::error_code ec;
+    std::uintmax_t size = fs::file_size(path, ec);
+    if (ec) return;
+    std::int64_t mtime = fileMtime(path, ec);
+    if (ec) return;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = entries.find(path);
+        if (it != entries.end() && it->second.size == size && it->second.mtime == mtime) {
+            return; // 缓存命中
+        }
+    }
+
+    Entry entry;
+    entry.size = size;
+    entry.mtime = mtime;
+    TrackMetadata meta;
+    MetadataExtractor::extract(path, meta);
+    if (!meta.album.empty()) {
+        entry.albumKey = fs::path(path).parent_path().string() + "\n" + meta.album;
+    }
+
+    bool analyzed = false;
+    if (meta.has_track_gain) {
+        // 已有 REPLAYGAIN 标签，无需解码
+        entry.info.fromTags = true;
+        entry.info.trackGain = meta.track_gain;
+        entry.info.truePeak = meta.track_peak;
+        entry.info.hasAlbumGain = meta.has_album_gain;
+        entry.info.albumGain = meta.album_gain;
+        entry.info.albumPeak = meta.album_peak;
+    } else if (measure(path, entry.info)) {
+        analyzed = true;
+    } else {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    addEntry(path, std::move(entry));
+    dirty = true;
+    if (analyzed) ++batchAnalyzed;
+}
+
+void LoudnessAnalyzer::addEntry(const std::string& path, Entry entry) {
+    removeEntry(path);
+    if (!entry.info.fromTags && entry.info.gatedBlocks > 0 && !entry.albumKey.empty()) {
+        AlbumLoudness& album = albums[entry.albumKey];
+        album.powerSum += entry.info.gatedPower * entry.info.gatedBlocks;
+        album.blocks += entry.info.gatedBlocks;
+        album.peak = std::max(album.peak, entry.info.truePeak);
+    }
+    entries[path] = std::move(entry);
+}
+
+void LoudnessAnalyzer::removeEntry(const std::string& path) {
+    auto it = entries.find(path);
+    if (it == entries.end()) return;
+    const Entry& old = it->second;
+    auto album = albums.find(old.albumKey);
+    if (album != albums.end() && !old.info.fromTags) {
+        album->second.powerSum -= old.info.gatedPower * old.info.gatedBlocks;
+        album->second.blocks -= old.info.gatedBlocks;
+        if (album->second.blocks <= 0) albums.erase(album);
+    }
+    entries.erase(it);
+}
+
+bool LoudnessAnalyzer::albumGain(const Entry& entry, double& gain, double& peak) const {
+    if (entry.info.hasAlbumGain) {
+        gain = entry.info.albumGain;
+        peak = entry.info.albumPeak;
+        return true;
+    }
+    // 专辑响度 = 专辑内所有已分析歌曲通过门限的响度块的平均功率
+    auto it = albums.find(entry.albumKey);
+    if (it == albums.end() || it->second.blocks <= 0) return false;
+    double loudness = powerToLufs(it->second.powerSum / it->second.blocks);
+    gain = std::max(-kMaxGain, std::min(kMaxGain, kReferenceLufs - loudness));
+    peak = it->second.peak;
+    return true;
+}
+
+bool LoudnessAnalyzer::lookup(const std::string& path, LoudnessInfo& out) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(path);
+    if (it == entries.end()) return false;
+    out = it->second.info;
+    return true;
+}
+
+float LoudnessAnalyzer::gainFor(const std::string& path, const TrackMetadata& meta, ReplayGainMode mode) {
+    if (mode == ReplayGainMode::OFF) return 1.0f;
+
+    double gain = 0.0;
+    double peak = 0.0;
+    bool found = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = entries.find(path);
+        if (it != entries.end()) {
+            found = true;
+            if (mode != ReplayGainMode::ALBUM || !albumGain(it->second, gain, peak)) {
+                gain = it->second.info.trackGain;
+                peak = it->second.info.truePeak;
+            }
+        }
+    }
+    if (!found) {
+        if (mode == ReplayGainMode::ALBUM && meta.has_album_gain) {
+            gain = meta.album_gain;
+            peak = meta.album_peak;
+        } else if (meta.has_track_gain) {
+            gain = meta.track_gain;
+            peak = meta.track_peak;
+        } else {
+            // 尚未分析：本次按原音量播放，尽快分析供下次使用
+            prioritize(path);
+            return 1.0f;
+        }
+    }
+
+    // 限制增益使峰值不超过满刻度
+    double linear = std::pow(10.0, gain / 20.0);
+    if (peak > 0.0) linear = std::min(linear, 1.0 / peak);
+    return (float)linear;
+}
+
+LoudnessStats LoudnessAnalyzer::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    LoudnessStats stats;
+    stats.processed = batchProcessed;
+    stats.analyzed = batchAnalyzed;
+    stats.pending = queue.size() + busyWorkers;
+    stats.threads = (unsigned int)workers.size();
+    auto end = stats.pending > 0 ? std::chrono::steady_clock::now() : batchEnd;
+    stats.seconds = std::chrono::duration<double>(end - batchStart).count();
+    return stats;
+}
+
+// --- 缓存持久化 ---
+fs::path LoudnessAnalyzer::getCacheFilePath() {
+    const char* home_env = std::getenv("HOME");
+    fs::path p = home_env ? fs::path(home_env) / ".config" / "simple_music_player" : fs::current_path();
+    if (!fs::exists(p)) fs::create_directories(p);
+    return p / "loudness_cache.json";
+}
+
+void LoudnessAnalyzer::loadCache() {
+    // 解析时不持有 mutex，避免阻塞 gainFor
+    std::vector<std::pair<std::string, Entry>> loaded;
+    fs::path p = getCacheFilePath();
+    if (fs::exists(p)) {
+        std::ifstream i(p);
+        try {
+            json j = json::parse(i);
+            if (j.contains("entries") && j["entries"].is_array()) {
+                loaded.reserve(j["entries"].size());
+                for (const auto& e : j["entries"]) {
+                    Entry entry;
+                    entry.size = e.value("size", (std::uintmax_t)0);
+                    entry.mtime = e.value("mtime", (std::int64_t)0);
+                    entry.albumKey = e.value("album_key", "");
+                    entry.info.integrated = e.value("integrated", 0.0);
+                    entry.info.truePeak = e.value("true_peak", 0.0);
+                    entry.info.trackGain = e.value("track_gain", 0.0);
+                    entry.info.albumGain = e.value("album_gain", 0.0);
+                    entry.info.albumPeak = e.value("album_peak", 0.0);
+                    entry.info.hasAlbumGain = e.value("has_album_gain", false);
+                    entry.info.fromTags = e.value("from_tags", false);
+                    entry.info.gatedPower = e.value("gated_power", 0.0);
+                    entry.info.gatedBlocks = e.value("gated_blocks", 0L);
+                    loaded.emplace_back(e.value("path", ""), std::move(entry));
+                }
+            }
+        } catch (...) {
+            // 缓存损坏时直接丢弃，下次保存时重建
+            loaded.clear();
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto& [path, entry] : loaded) {
+            if (entries.count(path) == 0) addEntry(path, std::move(entry));
+        }
+        cacheLoaded = true;
+    }
+    queueCv.notify_all();
+}
+
+void LoudnessAnalyzer::save() {
+    json j;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!dirty) return;
+        json entries_json = json::array();
+        for (const auto& [path, entry] : entries) {
+            json e;
+            e["path"] = path;
+            e["size"] = entry.size;
+            e["mtime"] = entry.mtime;
+            e["album_key"] = entry.albumKey;
+            e["integrated"] = entry.info.integrated;
+            e["true_peak"] = entry.info.truePeak;
+            e["track_gain"] = entry.info.trackGain;
+            e["album_gain"] = entry.info.albumGain;
+            e["album_peak"] = entry.info.albumPeak;
+            e["has_album_gain"] = entry.info.hasAlbumGain;
+            e["from_tags"] = entry.info.fromTags;
+            e["gated_power"] = entry.info.gatedPower;
+            e["gated_blocks"] = entry.info.gatedBlocks;
+            entries_json.push_back(std::move(e));
+        }
+        j["version"] = 1;
+        j["entries"] = std::move(entries_json);
+        dirty = false;
+    }
+
+    // 缓存文件较大，不做缩进；原子替换，避免写到一半退出导致缓存损坏
+    PersistenceWriter::writeAtomically(getCacheFilePath(), j.dump());
+}
@@ -0,0 +1,38 @@
+#include "LyricLayout.hpp"
+#include "TextLayout.hpp"
+#include <algorithm>
+
+void LyricLayout::update(const Lyrics& lyrics, int width) {
+    width = std::max(1, width);
+    if (lyrics.id() == lyricsId && width == layoutWidth) return;
+    lyricsId = lyrics.id();
+    layoutWidth = width;
+    cursor = -1;
+
+    times.clear();
+    firstRow.clear();
+    rows.clear();
+    times.reserve(lyrics.size());
+    firstRow.reserve(lyrics.size() + 1);
+    for (size_t i = 0; i < lyrics.size(); ++i) {
+        times.push_back(lyrics.timeMs(i));
+        firstRow.push_back((uint32_t)rows.size());
+        TextLayout::wrap(lyrics.text(i), width, rows);
+    }
+    firstRow.push_back((uint32_t)rows.size());
+}
+
+int LyricLayout::lineAt(int64_t ms) {
+    int count = (int)times.size();
+    auto starts = [&](int i) { return i < 0 || times[i] <= ms; };
+    auto ends = [&](int i) { return i + 1 >= count || times[i + 1] > ms; };
+
+    // 正常播放时当前行不变或只前进一行
+    if (cursor < count && starts(cursor)) {
+        if (ends(cursor)) return cursor;
+        if (ends(cursor + 1)) return ++cursor;
+    }
+    // 跳转：二分查找最后一个不晚于 ms 的行
+    cursor = (int)(std::upper_bound(times.begin(), times.end(), ms) - times.begin()) - 1;
+    return cursor;
+}
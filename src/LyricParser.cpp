@@ -0,0 +1,239 @@
+#include "LyricParser.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+namespace {
+const int kMaxStampsPerLine = 32;
+std::atomic<uint64_t> nextSerial{1};
+
+bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+std::string_view trim(std::string_view s) {
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\t' || s.back() == '\r')) s.remove_suffix(1);
+    return s;
+}
+
+// 读取连续数字，返回位数（最多 max_digits 位计入 value，其余跳过）
+size_t readDigits(std::string_view s, size_t& pos, int64_t& value, size_t max_digits = 9) {
+    size_t start = pos;
+    value = 0;
+    while (pos < s.size() && isDigit(s[pos])) {
+        if (pos - start < max_digits) value = value * 10 + (s[pos] - '0');
+        ++pos;
+    }
+    return pos - start;
+}
+
+// [offset:±毫秒]
+bool parseOffsetTag(std::string_view tag, int64_t& offset) {
+    const std::string_view key = "offset:";
+    if (tag.size() < key.size()) return false;
+    for (size_t i = 0; i < key.size(); ++i) {
+        char c = tag[i];
+        if (c >= 'A' && c <= 'Z') c = c - 'A' + 'a';
+        if (c != key[i]) return false;
+    }
+    std::string_view value = trim(tag.substr(key.size()));
+    bool negative = false;
+    if (!value.empty() && (value.front() == '+' || value.front() == '-')) {
+        negative = value.front() == '-';
+        value.remove_prefix(1);
+    }
+    size_t pos = 0;
+    int64_t ms = 0;
+    if (readDigits(value, pos, ms) == 0 || pos != value.size()) return false;
+    offset = negative ? -ms : ms;
+    return true;
+}
+
+// ID 标签（[ti:...]、[ar:...] 等）：字母开头，冒号前只有字母
+bool isIdTag(std::string_view tag) {
+    size_t colon = tag.find(':');
+    if (colon == std::string_view::npos || colon == 0) return false;
+    for (size_t i = 0; i < colon; ++i) {
+        char c = tag[i];
+        if (!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_')) return false;
+    }
+    return true;
+}
+
+// 旧实现（stringstream + substr + stod），仅用于性能对比
+size_t legacyParse(const std::string& raw) {
+    struct Line { double timestamp; std::string text; };
+    std::vector<Line> lyrics;
+    std::stringstream ss(raw);
+    std::string line;
+    while (std::getline(ss, line)) {
+        size_t close = line.find(']');
+        if (close != std::string::npos && line.size() > close + 1) {
+            std::string t = line.substr(0, close + 1);
+            double ts = -1;
+            if (t.size() >= 7 && t[0] == '[') {
+                try {
+                    ts = std::stoi(t.substr(1, 2)) * 60 + std::stod(t.substr(4, t.find(']') - 4));
+                } catch (...) { ts = -1; }
+            }
+            if (ts >= 0) lyrics.push_back({ts, line.substr(close + 1)});
+        }
+    }
+    std::sort(lyrics.begin(), lyrics.end(),
+              [](const Line& a, const Line& b) { return a.timestamp < b.timestamp; });
+    return lyrics.size();
+}
+}
+
+bool LyricParser::parseTimeTag(std::string_view tag, int64_t& ms) {
+    // mm:ss、mm:ss.x、mm:ss.xx、mm:ss.xxx 或 mm:ss:xx（分钟位数不限）
+    size_t pos = 0;
+    int64_t minutes = 0, seconds = 0, fraction = 0;
+    if (readDigits(tag, pos, minutes) == 0) return false;
+    if (pos >= tag.size() || tag[pos] != ':') return false;
+    ++pos;
+    size_t sec_digits = readDigits(tag, pos, seconds);
+    if (sec_digits == 0 || sec_digits > 2) return false;
+    if (pos < tag.size() && (tag[pos] == '.' || tag[pos] == ':')) {
+        ++pos;
+        size_t frac_digits = readDigits(tag, pos, fraction, 3);
+        if (frac_digits == 0) return false;
+        if (frac_digits == 1) fraction *= 100;
+        else if (frac_digits == 2) fraction *= 10;
+    }
+    if (pos != tag.size()) return false;
+    ms = (minutes * 60 + seconds) * 1000 + fraction;
+    return true;
+}
+
+Lyrics LyricParser::parse(std::string_view raw) {
+    Lyrics result;
+    if (raw.size() >= 3 && raw.substr(0, 3) == "\xEF\xBB\xBF") raw.remove_prefix(3); // UTF-8 BOM
+    if (raw.empty()) return result;
+    // 文本只会比原文短，一次分配即可
+    result.arena.reserve(raw.size());
+
+    int64_t stamps[kMaxStampsPerLine];
+    size_t pos = 0;
+    while (pos < raw.size()) {
+        size_t end = raw.find('\n', pos);
+        if (end == std::string_view::npos) end = raw.size();
+        std::string_view line = trim(raw.substr(pos, end - pos));
+        pos = end + 1;
+
+        // 行首连续的方括号标签
+        int stamp_count = 0;
+        while (!line.empty() && line.front() == '[') {
+            size_t close = line.find(']');
+            if (close == std::string_view::npos) break;
+            std::string_view tag = trim(line.substr(1, close - 1));
+            int64_t ms;
+            if (parseTimeTag(tag, ms)) {
+                if (stamp_count < kMaxStampsPerLine) stamps[stamp_count++] = ms;
+            } else if (parseOffsetTag(tag, result.offset) || isIdTag(tag)) {
+                // 头部信息标签
+            } else {
+                break; // 不是标签，方括号属于歌词文本
+            }
+            line.remove_prefix(close + 1);
+        }
+        if (stamp_count == 0) continue;
+
+        // 空文本也保留：LRC 用它表示间奏（清空当前歌词）
+        std::string_view text = trim(line);
+        LyricLine entry;
+        entry.offset = (uint32_t)result.arena.size();
+        entry.length = (uint32_t)text.size();
+        result.arena.append(text.data(), text.size());
+        for (int i = 0; i < stamp_count; ++i) {
+            entry.timeMs = stamps[i];
+            result.lines.push_back(entry);
+        }
+    }
+
+    // [offset:] 为正时歌词提前显示
+    if (result.offset != 0) {
+        for (auto& line : result.lines) {
+            line.timeMs = std::max<int64_t>(0, line.timeMs - result.offset);
+        }
+    }
+    // 多时间戳的行会打乱顺序；时间相同时保持原文顺序
+    std::stable_sort(result.lines.begin(), result.lines.end(),
+                     [](const LyricLine& a, const LyricLine& b) { return a.timeMs < b.timeMs; });
+    if (!result.lines.empty()) result.serial = nextSerial.fetch_add(1, std::memory_order_relaxed);
+    return result;
+}
+
+std::string LyricParser::findSidecar(const std::string& audio_path) {
+    std::error_code ec;
+    for (const char* ext : {".lrc", ".LRC"}) {
+        fs::path candidate = fs::path(audio_path).replace_extension(ext);
+        if (fs::is_regular_file(candidate, ec)) return candidate.string();
+    }
+    return "";
+}
+
+bool LyricParser::readFile(const std::string& path, std::string& out) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) return false;
+    in.seekg(0, std::ios::end);
+    std::streamoff size = in.tellg();
+    if (size < 0) return false;
+    in.seekg(0, std::ios::beg);
+    out.resize((size_t)size);
+    return size == 0 || (bool)in.read(&out[0], size);
+}
+
+void LyricParser::benchmark(std::ostream& out) {
+    // 生成多语言歌词：中/日/韩/英/俄文和 emoji，部分行带多个时间戳和三位毫秒
+    const char* samples[] = {
+        "在这个漫长的夜里 我依然想念你的笑容",
+        "夜空に輝く星のように 君を照らしたい",
+        "너의 목소리가 들려 오늘 밤도 잠 못 들어",
+        "And I will always find my way back home to you",
+        "Я буду ждать тебя всегда, моя любовь",
+        "🎵 La la la 🎶 oh oh oh ✨",
+    };
+    const int kLines = 50000;
+    std::string raw = "\xEF\xBB\xBF[ti:Benchmark]\n[ar:Various]\n[offset:+250]\n";
+    char stamp[64];
+    for (int i = 0; i < kLines; ++i) {
+        int ms = i * 2370;
+        if (i % 5 == 0) {
+            snprintf(stamp, sizeof(stamp), "[%02d:%02d.%02d][%02d:%02d.%03d]", ms / 60000, ms / 1000 % 60,
+                     ms / 10 % 100, (ms + 600000) / 60000, (ms + 600000) / 1000 % 60, ms % 1000);
+        } else {
+            snprintf(stamp, sizeof(stamp), "[%02d:%02d.%02d]", ms / 60000, ms / 1000 % 60, ms / 10 % 100);
+        }
+        raw += stamp;
+        raw += samples[i % 6];
+        raw += (i % 7 == 0) ? "\r\n" : "\n";
+    }
+
+    const int iterations = 20;
+    double mb = raw.size() / (1024.0 * 1024.0);
+    char line[160];
+    snprintf(line, sizeof(line), "歌词解析测试: %d 行, %.2f MB, %d 次\n", kLines, mb, iterations);
+    out << line;
+
+    size_t parsed = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int it = 0; it < iterations; ++it) parsed = parse(raw).size();
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / iterations;
+
+    size_t legacy_parsed = 0;
+    start = std::chrono::steady_clock::now();
+    for (int it = 0; it < iterations; ++it) legacy_parsed = legacyParse(raw);
+    double legacy_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / iterations;
+
+    snprintf(line, sizeof(line), "  string_view  %8.2f ms  %7.1f MB/s  %zu 条\n", ms, mb / (ms / 1000.0), parsed);
+    out << line;
+    snprintf(line, sizeof(line), "  stringstream %8.2f ms  %7.1f MB/s  %zu 条  加速 %.2fx\n",
+             legacy_ms, mb / (legacy_ms / 1000.0), legacy_parsed, legacy_ms / ms);
+    out << line;
+}
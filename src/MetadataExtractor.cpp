@@ -0,0 +1,123 @@
+#include "MetadataExtractor.hpp"
+#include <taglib/fileref.h>
+#include <taglib/tag.h>
+#include <taglib/mpegfile.h>
+#include <taglib/id3v2tag.h>
+#include <taglib/flacfile.h>
+#include <taglib/vorbisfile.h>
+#include <taglib/opusfile.h>
+#include <taglib/mp4file.h>
+#include <taglib/xiphcomment.h>
+#include <taglib/tpropertymap.h>
+#include <algorithm>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// 解析 "-6.52 dB" 或 "0.988553" 形式的数值，失败返回 false
+bool readNumber(const TagLib::PropertyMap& props, const char* key, double& out) {
+    if (!props.contains(key) || props[key].isEmpty()) return false;
+    try {
+        out = std::stod(props[key].front().to8Bit(true));
+        return true;
+    } catch (...) {
+        return false;
+    }
+}
+
+void readReplayGain(TagLib::File& file, TrackMetadata& out) {
+    TagLib::PropertyMap props = file.properties();
+    out.has_track_gain = readNumber(props, "REPLAYGAIN_TRACK_GAIN", out.track_gain);
+    out.has_album_gain = readNumber(props, "REPLAYGAIN_ALBUM_GAIN", out.album_gain);
+    readNumber(props, "REPLAYGAIN_TRACK_PEAK", out.track_peak);
+    readNumber(props, "REPLAYGAIN_ALBUM_PEAK", out.album_peak);
+}
+
+// 填充所有格式通用的标签和音频属性
+void readCommon(TagLib::File& file, TrackMetadata& out) {
+    if (TagLib::Tag* tag = file.tag()) {
+        out.title = tag->title().to8Bit(true);
+        out.artist = tag->artist().to8Bit(true);
+        out.album = tag->album().to8Bit(true);
+        out.track_number = tag->track();
+    }
+    if (TagLib::AudioProperties* props = file.audioProperties()) {
+        out.duration = props->lengthInSeconds();
+        out.sample_rate = props->sampleRate();
+        out.channels = props->channels();
+        out.bitrate = props->bitrate();
+    }
+    readReplayGain(file, out);
+}
+
+// Xiph 注释（FLAC、Ogg Vorbis、Opus）中的歌词字段
+std::string xiphLyrics(const TagLib::Ogg::XiphComment* comment) {
+    if (!comment) return "";
+    const auto& fields = comment->fieldListMap();
+    for (const char* key : {"LYRICS", "UNSYNCEDLYRICS"}) {
+        if (fields.contains(key) && !fields[key].isEmpty()) {
+            return fields[key].front().to8Bit(true);
+        }
+    }
+    return "";
+}
+
+} // namespace
+
+bool MetadataExtractor::extract(const std::string& path, TrackMetadata& out) {
+    std::string ext = fs::path(path).extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+
+    if (ext == ".mp3") {
+        TagLib::MPEG::File f(path.c_str());
+        if (!f.isValid()) return false;
+        readCommon(f, out);
+        if (auto* id3 = f.ID3v2Tag()) {
+            auto frames = id3->frameList("USLT");
+            if (!frames.isEmpty()) out.lyrics = frames.front()->toString().to8Bit(true);
+        }
+        return true;
+    }
+    if (ext == ".flac") {
+        TagLib::FLAC::File f(path.c_str());
+        if (!f.isValid()) return false;
+        readCommon(f, out);
+        out.lyrics = xiphLyrics(f.xiphComment());
+        return true;
+    }
+    if (ext == ".ogg" || ext == ".oga") {
+        TagLib::Ogg::Vorbis::File f(path.c_str());
+        if (!f.isValid()) return false;
+        readCommon(f, out);
+        out.lyrics = xiphLyrics(f.tag());
+        return true;
+    }
+    if (ext == ".opus") {
+        TagLib::Ogg::Opus::File f(path.c_str());
+        if (!f.isValid()) return false;
+        readCommon(f, out);
+        out.lyrics = xiphLyrics(f.tag());
+        return true;
+    }
+    if (ext == ".m4a" || ext == ".mp4" || ext == ".aac") {
+        TagLib::MP4::File f(path.c_str());
+        if (!f.isValid()) return false;
+        readCommon(f, out);
+        if (auto* tag = f.tag()) {
+            const auto& items = tag->itemMap();
+            if (items.contains("\251lyr")) {
+                auto lyrics = items["\251lyr"].toStringList();
+                if (!lyrics.isEmpty()) out.lyrics = lyrics.front().to8Bit(true);
+            }
+        }
+        return true;
+    }
+
+    // 其他格式：交给 FileRef 自动识别，不读取歌词
+    TagLib::FileRef f(path.c_str());
+    if (f.isNull() || !f.file()) return false;
+    readCommon(*f.file(), out);
+    return true;
+}
@@ -1,147 +1,596 @@
 #include "MusicPlayer.hpp"
-#include <taglib/fileref.h>
-#include <taglib/mpegfile.h>
-#include <taglib/id3v2tag.h>
-#include <taglib/flacfile.h>
-#include <taglib/xiphcomment.h>
-#include <sstream>
+#include "MetadataExtractor.hpp"
 #include <iostream>
+#include <cmath>
+#include <cstring>
+
+namespace {
+const int kMixChunkFrames = 4096; // 解码线程每次处理的帧数
+const double kRingSeconds = 1.5;  // 环形缓冲区可容纳的时长
+const double kHalfPi = 1.57079632679489661923;
+const int kFallbackRate = 44100;  // 自动模式下尚未播放歌曲时使用的采样率
+
+Uint16 toSdlFormat(SampleFormat format) {
+    switch (format) {
+        case SampleFormat::S32: return AUDIO_S32SYS;
+        case SampleFormat::F32: return AUDIO_F32SYS;
+        default: return AUDIO_S16SYS;
+    }
+}
+}
+
+const char* MusicPlayer::formatName(SampleFormat format) {
+    switch (format) {
+        case SampleFormat::S32: return "s32";
+        case SampleFormat::F32: return "f32";
+        default: return "s16";
+    }
+}
+
+SampleFormat MusicPlayer::parseFormat(const std::string& name) {
+    if (name == "s32") return SampleFormat::S32;
+    if (name == "f32") return SampleFormat::F32;
+    return SampleFormat::S16;
+}
 
 MusicPlayer::MusicPlayer() {
+    // DSP 处理链：目前只有参数均衡器，必须在打开设备前添加
+    auto eq = std::make_unique<ParametricEq>();
+    equalizer = eq.get();
+    dspChain.add(std::move(eq));
+    
     if (SDL_Init(SDL_INIT_AUDIO) < 0) {
         // SDL初始化失败，但仍然设置默认音量
         currentVolume = 80;
         return;
     }
-    if (Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 2048) < 0) {
-        // Mixer初始化失败
-        currentVolume = 80;
-        return;
-    }
     
     // 设置初始音量
     setVolume(currentVolume);
+    
+    decodeRunning = true;
+    decodeThread = std::thread(&MusicPlayer::decodeLoop, this);
+    
+    // 先按默认参数打开设备，读取配置后再由 configureDevice 调整
+    std::lock_guard<std::mutex> lock(engineMutex);
+    openDevice(kFallbackRate);
 }
 
 MusicPlayer::~MusicPlayer() {
+    {
+        std::lock_guard<std::mutex> lock(engineMutex);
+        closeDevice();
+        decodeRunning = false;
+    }
+    decodeCv.notify_all();
+    if (decodeThread.joinable()) decodeThread.join();
     stop();
-    Mix_CloseAudio();
     SDL_Quit();
 }
 
+bool MusicPlayer::openDevice(int rate) {
+    SDL_AudioSpec want{};
+    want.freq = rate;
+    want.format = toSdlFormat(deviceConfig.format);
+    want.channels = 2;
+    want.samples = (Uint16)deviceConfig.bufferFrames;
+    want.callback = &MusicPlayer::audioCallback;
+    want.userdata = this;
+    SDL_AudioSpec have{};
+    device = SDL_OpenAudioDevice(nullptr, 0, &want, &have,
+                                 SDL_AUDIO_ALLOW_FREQUENCY_CHANGE | SDL_AUDIO_ALLOW_CHANNELS_CHANGE);
+    if (device == 0) {
+        // 音频设备打开失败
+        return false;
+    }
+    
+    // 记录设备实际参数，解码器按此输出
+    outRate = have.freq;
+    outFormat = have.format;
+    outChannels = have.channels;
+    latencyFrames = have.samples;
+    outBuffer.assign((size_t)have.samples * outChannels, 0.0f);
+    mixBuffer.assign((size_t)kMixChunkFrames * outChannels, 0.0f);
+    fadeBuffer.assign((size_t)kMixChunkFrames * outChannels, 0.0f);
+    ring.reset((size_t)(outRate * kRingSeconds) * outChannels);
+    flushMark.store(kNoMark, std::memory_order_relaxed);
+    trackMark.store(kNoMark, std::memory_order_relaxed);
+    gainStage.reset(outRate, outChannels);
+    dspChain.prepare(outRate, outChannels);
+    audioOpen = true;
+    
+    SDL_PauseAudioDevice(device, 0);
+    return true;
+}
+
+void MusicPlayer::closeDevice() {
+    if (!audioOpen) return;
+    // 关闭后音频回调不会再被调用
+    SDL_CloseAudioDevice(device);
+    device = 0;
+    audioOpen = false;
+}
+
+bool MusicPlayer::reopenDevice(int rate) {
+    // 设备参数改变会清空缓冲区：记下当前位置，重开后从这里继续解码
+    double position = getElapsedSeconds();
+    int old_rate = outRate;
+    
+    closeDevice();
+    if (!openDevice(rate) && !openDevice(old_rate)) {
+        return false;
+    }
+    
+    if (decoder) {
+        decoder->setOutput(outRate, outChannels);
+        decoder->seek(position);
+    }
+    fadingOut.reset();
+    fadeLength = 0;
+    streamEnded = false;
+    long long frame = (long long)(position * outRate);
+    segmentStart.store(frame, std::memory_order_relaxed);
+    playedFrames.store(frame, std::memory_order_relaxed);
+    resetDecodePosition(frame);
+    decodeCv.notify_one();
+    return true;
+}
+
+bool MusicPlayer::configureDevice(const AudioDeviceConfig& config) {
+    AudioDeviceConfig sanitized = config;
+    if (sanitized.sampleRate < 0) sanitized.sampleRate = 0;
+    // 缓冲区帧数取为 2 的幂
+    int frames = kMinBufferFrames;
+    while (frames < sanitized.bufferFrames && frames < kMaxBufferFrames) frames <<= 1;
+    sanitized.bufferFrames = frames;
+    
+    if (audioOpen && sanitized == deviceConfig) return true;
+    
+    bool ok;
+    {
+        std::lock_guard<std::mutex> lock(engineMutex);
+        deviceConfig = sanitized;
+        int rate = deviceConfig.sampleRate;
+        if (rate == 0) {
+            // 自动模式：沿用当前歌曲的原始采样率
+            rate = (decoder && decoder->sourceRate() > 0) ? decoder->sourceRate() : kFallbackRate;
+        }
+        ok = reopenDevice(rate);
+    }
+    if (prepared.decoder) {
+        prepared.decoder->setOutput(outRate, outChannels);
+    }
+    return ok;
+}
+
+bool MusicPlayer::matchTrackRate() {
+    // 仅自动模式：歌曲原始采样率与设备不同时重新打开设备，省去重采样
+    if (deviceConfig.sampleRate != 0 || !decoder) return false;
+    int rate = decoder->sourceRate();
+    if (rate <= 0 || rate == outRate) return false;
+    return reopenDevice(rate);
+}
+
+void MusicPlayer::audioCallback(void* udata, Uint8* stream, int len) {
+    static_cast<MusicPlayer*>(udata)->renderAudio(stream, len);
+}
+
+void MusicPlayer::renderAudio(Uint8* stream, int len) {
+    int bytes_per_sample = (outFormat == AUDIO_S16SYS) ? 2 : 4;
+    int total_frames = len / (bytes_per_sample * outChannels);
+    
+    // 1. 跳转/切歌：丢弃旧数据并同步进度
+    uint64_t flush = flushMark.exchange(kNoMark, std::memory_order_acq_rel);
+    if (flush != kNoMark) {
+        ring.discardUntil(flush);
+        long long frame = flushFrame.load(std::memory_order_relaxed);
+        segmentStart.store(frame, std::memory_order_relaxed);
+        playedFrames.store(frame, std::memory_order_relaxed);
+    }
+    
+    if (!playing || paused) {
+        std::memset(stream, 0, len);
+        return;
+    }
+    
+    int max_frames = (int)(outBuffer.size() / outChannels);
+    int done = 0;
+    while (done < total_frames) {
+        int frames = std::min(total_frames - done, max_frames);
+        size_t samples = (size_t)frames * outChannels;
+        float* buf = outBuffer.data();
+        
+        // 2. 从环形缓冲区取数据，不足部分补静音
+        uint64_t read_pos = ring.readPosition();
+        size_t got = ring.read(buf, samples);
+        if (got < samples) {
+            std::fill(buf + got, buf + samples, 0.0f);
+            // 歌曲已解码完毕或刚开始播放（解码线程尚未写入）时不算断流
+            bool started = playedFrames.load(std::memory_order_relaxed) !=
+                           segmentStart.load(std::memory_order_relaxed);
+            if (started && !streamEnded.load(std::memory_order_relaxed)) {
+                underruns.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        
+        // 3. 更新进度；越过交叉淡变标记时从新歌曲的第 0 帧开始计
+        uint64_t mark = trackMark.load(std::memory_order_acquire);
+        if (mark != kNoMark && mark <= read_pos + got) {
+            long long after = (long long)(read_pos + got - std::max(mark, read_pos)) / outChannels;
+            segmentStart.store(0, std::memory_order_relaxed);
+            playedFrames.store(after, std::memory_order_relaxed);
+            trackMark.compare_exchange_strong(mark, kNoMark, std::memory_order_acq_rel);
+        } else {
+            playedFrames.fetch_add((long long)got / outChannels, std::memory_order_relaxed);
+        }
+        
+        // 4. 经过 DSP 处理链，应用音量（平滑过渡），复制给可视化抽头，再转换为设备格式
+        dspChain.process(buf, frames);
+        gainStage.process(buf, frames);
+        tap.write(buf, frames, outChannels);
+        if (outFormat == AUDIO_F32SYS) {
+            float* dst = reinterpret_cast<float*>(stream) + (size_t)done * outChannels;
+            std::memcpy(dst, buf, samples * sizeof(float));
+        } else if (outFormat == AUDIO_S32SYS) {
+            Sint32* dst = reinterpret_cast<Sint32*>(stream) + (size_t)done * outChannels;
+            for (size_t i = 0; i < samples; ++i) {
+                double v = std::max(-1.0f, std::min(1.0f, buf[i]));
+                dst[i] = (Sint32)(v * 2147483647.0);
+            }
+        } else {
+            Sint16* dst = reinterpret_cast<Sint16*>(stream) + (size_t)done * outChannels;
+            for (size_t i = 0; i < samples; ++i) {
+                float v = std::max(-1.0f, std::min(1.0f, buf[i]));
+                dst[i] = (Sint16)(v * 32767.0f);
+            }
+        }
+        done += frames;
+    }
+}
+
+void MusicPlayer::decodeLoop() {
+    std::unique_lock<std::mutex> lock(engineMutex);
+    while (decodeRunning) {
+        size_t chunk_samples = (size_t)kMixChunkFrames * outChannels;
+        auto can_decode = [&]() {
+            return playing && decoder && !streamEnded && ring.space() >= chunk_samples;
+        };
+        if (can_decode()) {
+            decodeChunk();
+            continue;
+        }
+        
+        // 当前歌曲的数据已被音频回调全部取走：通知播放结束
+        if (playing && streamEnded && ring.readPosition() >= endPosition) {
+            playing = false;
+            std::function<void()> callback = finishedCallback;
+            lock.unlock();
+            if (callback) callback();
+            lock.lock();
+            continue;
+        }
+        
+        if (playing && !paused && decoder) {
+            // 正在播放但缓冲区已满，或已解码完毕、剩余数据尚未播完：音频回调取走数据时
+            // 不能加锁通知，只能定时检查；播完的等待时长按缓冲区中剩余的数据估算
+            auto wait = std::chrono::milliseconds(5);
+            if (streamEnded) {
+                uint64_t read_pos = ring.readPosition();
+                uint64_t left = endPosition > read_pos ? endPosition - read_pos : 0;
+                wait = std::max(wait, std::chrono::milliseconds(left * 1000 / ((uint64_t)outChannels * outRate)));
+            }
+            decodeCv.wait_for(lock, wait);
+        } else {
+            // 未播放、已暂停或没有解码器：阻塞到播放/继续/加载/跳转/停止/退出时被唤醒
+            decodeCv.wait(lock, [&]() {
+                return !decodeRunning || (playing && !paused && decoder) || can_decode();
+            });
+        }
+    }
+}
+
+void MusicPlayer::decodeChunk() {
+    int frames = kMixChunkFrames;
+    int samples = frames * outChannels;
+    float* mix = mixBuffer.data();
+    
+    // 1. 解码当前歌曲
+    int got = decoder->read(mix, frames);
+    std::fill(mix + got * outChannels, mix + samples, 0.0f);
+    int out_frames = got;
+    decodedFrames.fetch_add(got, std::memory_order_relaxed);
+    
+    // 2. 交叉淡入淡出：等功率曲线混合上一首和当前歌曲；
+    // 上一首提前解码完毕时按静音继续，当前歌曲的增益仍按曲线升到 1
+    if (fadePosition < fadeLength) {
+        float* fade = fadeBuffer.data();
+        int fade_got = fadingOut ? fadingOut->read(fade, frames) : 0;
+        std::fill(fade + fade_got * outChannels, fade + samples, 0.0f);
+        for (int i = 0; i < frames; ++i) {
+            double t = std::min(1.0, (double)(fadePosition + i) / fadeLength);
+            float gain_in = (float)std::sin(t * kHalfPi);
+            float gain_out = (float)std::cos(t * kHalfPi);
+            for (int c = 0; c < outChannels; ++c) {
+                int idx = i * outChannels + c;
+                mix[idx] = mix[idx] * gain_in + fade[idx] * gain_out;
+            }
+        }
+        out_frames = std::max(got, fade_got);
+        fadePosition += frames;
+        if (fadePosition >= fadeLength || (fadingOut && fadingOut->finished())) {
+            fadingOut.reset(); // 只释放解码器，淡变进度保留
+        }
+    }
+    
+    ring.write(mix, (size_t)out_frames * outChannels);
+    
+    if (got < frames && decoder->finished()) {
+        // 当前歌曲解码完毕，等音频回调播放完缓冲区中的剩余数据
+        fadingOut.reset();
+        fadeLength = 0;
+        endPosition = ring.writePosition();
+        streamEnded = true;
+    }
+}
+
+void MusicPlayer::requestFlush(long long frame) {
+    // 解码线程此时被 engineMutex 挡住，写位置不会变化
+    trackMark.store(kNoMark, std::memory_order_relaxed);
+    flushFrame.store(frame, std::memory_order_relaxed);
+    flushMark.store(ring.writePosition(), std::memory_order_release);
+    segmentStart.store(frame, std::memory_order_relaxed);
+    playedFrames.store(frame, std::memory_order_relaxed);
+    streamEnded = false;
+    resetDecodePosition(frame);
+}
+
+void MusicPlayer::resetDecodePosition(long long frame) {
+    decodedFrames.store(frame, std::memory_order_relaxed);
+    long long total = decoder ? (long long)std::llround(decoder->duration() * outRate) : 0;
+    trackFrames.store(total, std::memory_order_relaxed);
+}
+
 bool MusicPlayer::load(const std::string& path) {
-    stop(); // 加载新歌前先停止并释放旧资源
-    music = Mix_LoadMUS(path.c_str());
-    if (!music) return false;
+    // 单曲循环等重新播放同一首歌的情况：直接复用已打开的解码器
+    if (decoder && path == currentFilePath) {
+        std::lock_guard<std::mutex> lock(engineMutex);
+        fadingOut.reset();
+        fadeLength = 0;
+        playing = false;
+        requestFlush(0);
+        return decoder->seek(0);
+    }
+    
+    PreparedTrack track;
+    if (isPrefetched(path)) {
+        // 已预加载：只交换指针，增益按最新的分析结果重新计算
+        track = std::move(prepared);
+        prepared = PreparedTrack();
+        track.decoder->setGain(resolveGain(path, track.tags));
+    } else if (!readTrack(path, track)) {
+        stop();
+        return false;
+    }
+    
+    // 在锁内交换，旧的解码器在锁外释放
+    float decoder_gain = 1.0f;
+    std::unique_ptr<AudioDecoder> old_decoder;
+    std::unique_ptr<AudioDecoder> old_fading;
+    {
+        std::lock_guard<std::mutex> lock(engineMutex);
+        old_decoder = std::move(decoder);
+        old_fading = std::move(fadingOut);
+        fadeLength = 0;
+        decoder = std::move(track.decoder);
+        decoder_gain = decoder->getGain();
+        playing = false;
+        paused = false;
+        requestFlush(0);
+        if (matchTrackRate() && prepared.decoder) {
+            prepared.decoder->setOutput(outRate, outChannels);
+        }
+    }
+    decodeCv.notify_one();
+    trackGain = decoder_gain;
+    currentSong = std::move(track.info);
+    currentTags = std::move(track.tags);
+    currentFilePath = path;
+    return true;
+}
 
+bool MusicPlayer::prefetch(const std::string& path) {
+    if (path.empty() || path == currentFilePath) return false;
+    if (isPrefetched(path)) return true;
+    
+    prepared = PreparedTrack();
+    return readTrack(path, prepared);
+}
+
+bool MusicPlayer::crossfadeTo(const std::string& path) {
+    // 未开启淡变或当前没有在播放：直接切换
+    if (crossfadeSeconds <= 0 || !isPlaying() || isPaused() || path == currentFilePath) {
+        if (!load(path)) return false;
+        play();
+        return true;
+    }
+    
+    PreparedTrack track;
+    if (isPrefetched(path)) {
+        track = std::move(prepared);
+        prepared = PreparedTrack();
+        track.decoder->setGain(resolveGain(path, track.tags));
+    } else if (!readTrack(path, track)) {
+        return false;
+    }
+    
+    float decoder_gain = track.decoder->getGain();
+    std::unique_ptr<AudioDecoder> old_fading;
+    {
+        std::lock_guard<std::mutex> lock(engineMutex);
+        old_fading = std::move(fadingOut);
+        fadingOut = std::move(decoder);
+        decoder = std::move(track.decoder);
+        fadePosition = 0;
+        fadeLength = (long)crossfadeSeconds * outRate;
+        playing = true;
+        paused = false;
+        streamEnded = false;
+        // 缓冲区中已有的旧歌曲数据照常播放，新歌曲从当前写位置开始计时
+        trackMark.store(ring.writePosition(), std::memory_order_release);
+        resetDecodePosition(0);
+    }
+    decodeCv.notify_one();
+    trackGain = decoder_gain;
+    currentSong = std::move(track.info);
+    currentTags = std::move(track.tags);
     currentFilePath = path;
+    return true;
+}
+
+bool MusicPlayer::readTrack(const std::string& path, PreparedTrack& out) const {
+    out.decoder = std::make_unique<AudioDecoder>();
+    if (!out.decoder->open(path, outRate, outChannels)) {
+        out.decoder.reset();
+        return false;
+    }
+    out.path = path;
     
-    // 1. 解析元数据
-    TagLib::FileRef f(path.c_str());
-    if (!f.isNull() && f.tag()) {
-        currentSong.title = f.tag()->title().to8Bit(true);
-        currentSong.artist = f.tag()->artist().to8Bit(true);
-        if (f.audioProperties()) {
-            currentSong.duration = f.audioProperties()->lengthInSeconds();
-        }
+    // 1. 一次打开文件，同时读取元数据、音频属性和内嵌歌词
+    TrackMetadata meta;
+    if (MetadataExtractor::extract(path, meta)) {
+        out.info.title = meta.title;
+        out.info.artist = meta.artist;
+        out.info.album = meta.album;
+        out.info.duration = meta.duration;
+        out.info.sampleRate = meta.sample_rate;
+        out.info.channels = meta.channels;
+        out.info.bitrate = meta.bitrate;
+    }
+    if (out.info.duration <= 0) {
+        out.info.duration = (int)out.decoder->duration();
+    }
+    
+    // 2. 解析歌词：优先使用音频文件旁的同名 .lrc 文件，其次是内嵌歌词
+    std::string sidecar = LyricParser::findSidecar(path);
+    std::string sidecar_text;
+    if (!sidecar.empty() && LyricParser::readFile(sidecar, sidecar_text)) {
+        out.info.lyrics = LyricParser::parse(sidecar_text);
+    }
+    if (out.info.lyrics.empty()) {
+        out.info.lyrics = LyricParser::parse(meta.lyrics);
     }
     
-    // 2. 解析歌词
-    parseLyrics(path);
+    // 3. 响度均衡增益
+    meta.lyrics.clear();
+    out.tags = std::move(meta);
+    out.decoder->setGain(resolveGain(path, out.tags));
     return true;
 }
 
+float MusicPlayer::resolveGain(const std::string& path, const TrackMetadata& tags) const {
+    return gainResolver ? gainResolver(path, tags) : 1.0f;
+}
+
+void MusicPlayer::setGainResolver(GainResolver resolver) {
+    gainResolver = std::move(resolver);
+}
+
+void MusicPlayer::refreshTrackGain() {
+    if (currentFilePath.empty()) return;
+    float gain = resolveGain(currentFilePath, currentTags);
+    {
+        std::lock_guard<std::mutex> lock(engineMutex);
+        if (decoder) decoder->setGain(gain);
+    }
+    trackGain = gain;
+    if (prepared.decoder) {
+        prepared.decoder->setGain(resolveGain(prepared.path, prepared.tags));
+    }
+}
+
 void MusicPlayer::play() {
-    if (music) {
-        Mix_PlayMusic(music, 1);
-        startTicks = SDL_GetTicks();
-        pauseTotalTicks = 0;
+    // 在锁内修改状态，解码线程检查等待条件和进入等待之间不会漏掉通知
+    {
+        std::lock_guard<std::mutex> lock(engineMutex);
+        if (!decoder) return;
+        playing = true;
+        paused = false;
     }
+    decodeCv.notify_one();
 }
 
 void MusicPlayer::pause() {
-    if (music && !Mix_PausedMusic()) {
-        Mix_PauseMusic();
-        pauseStartTicks = SDL_GetTicks();
+    if (playing && !paused) {
+        paused = true;
     }
 }
 
 void MusicPlayer::resume() {
-    if (music && Mix_PausedMusic()) {
-        Mix_ResumeMusic();
-        pauseTotalTicks += (SDL_GetTicks() - pauseStartTicks);
+    {
+        std::lock_guard<std::mutex> lock(engineMutex);
+        if (!playing || !paused) return;
+        paused = false;
     }
+    decodeCv.notify_one();
 }
 
 void MusicPlayer::stop() {
-    if (music) {
-        Mix_HaltMusic();
-        Mix_FreeMusic(music);
-        music = nullptr;
+    std::unique_ptr<AudioDecoder> old_decoder;
+    std::unique_ptr<AudioDecoder> old_fading;
+    {
+        std::lock_guard<std::mutex> lock(engineMutex);
+        old_decoder = std::move(decoder);
+        old_fading = std::move(fadingOut);
+        fadeLength = 0;
+        playing = false;
+        paused = false;
+        requestFlush(0);
     }
+    decodeCv.notify_one();
     currentSong = SongInfo(); // 重置当前歌曲信息
 }
 
-bool MusicPlayer::isPaused() const { return Mix_PausedMusic(); }
+bool MusicPlayer::isPaused() const { return playing && paused; }
 
 bool MusicPlayer::isPlaying() const { 
-    // Mix_PlayingMusic 在暂停时也会返回真，所以这样判断更准确
-    return Mix_PlayingMusic() != 0; 
+    // 暂停时也返回真
+    return playing; 
 }
 
 double MusicPlayer::getElapsedSeconds() const {
     if (!isPlaying() && !isPaused()) return 0;
-    Uint32 current = isPaused() ? pauseStartTicks : SDL_GetTicks();
-    return (current - startTicks - pauseTotalTicks) / 1000.0;
-}
-
-std::string MusicPlayer::fetchEmbeddedLyrics(const std::string& path) {
-    // 尝试解析 MP3 ID3v2
-    TagLib::MPEG::File m(path.c_str());
-    if (m.isValid() && m.ID3v2Tag()) {
-        auto f = m.ID3v2Tag()->frameList("USLT");
-        if (!f.isEmpty()) return f.front()->toString().to8Bit(true);
-    }
-    // 尝试解析 FLAC XiphComment
-    TagLib::FLAC::File fl(path.c_str());
-    if (fl.isValid() && fl.xiphComment()) {
-        auto d = fl.xiphComment()->fieldListMap();
-        if (d.contains("LYRICS")) return d["LYRICS"].front().to8Bit(true);
-    }
-    return "";
-}
-
-double MusicPlayer::parseTime(const std::string& t) {
-    if (t.size() < 7 || t[0] != '[') return -1;
-    try {
-        // 支持 [mm:ss.xx] 格式
-        return std::stoi(t.substr(1,2)) * 60 + std::stod(t.substr(4, t.find(']') - 4));
-    } catch(...) { return -1; }
-}
-
-void MusicPlayer::parseLyrics(const std::string& path) {
-    currentSong.lyrics.clear();
-    std::string raw = fetchEmbeddedLyrics(path);
-    if (raw.empty()) return;
-
-    std::stringstream ss(raw);
-    std::string line;
-    while(std::getline(ss, line)) {
-        size_t closePos = line.find(']');
-        if(closePos != std::string::npos && line.size() > closePos + 1) {
-            double ts = parseTime(line.substr(0, closePos + 1));
-            if (ts >= 0) {
-                currentSong.lyrics.push_back({ts, line.substr(closePos + 1)});
-            }
-        }
-    }
-    // 排序确保 UI 逻辑正常
-    std::sort(currentSong.lyrics.begin(), currentSong.lyrics.end(), 
-              [](const LyricLine& a, const LyricLine& b) { return a.timestamp < b.timestamp; });
+    // 交叉淡变时新歌曲已成为当前歌曲，但缓冲区中还在播放上一首：新歌曲的进度从 0 开始
+    if (trackMark.load(std::memory_order_acquire) != kNoMark) return 0;
+    // 已交给设备的帧还要经过设备缓冲区才能听到，减去缓冲延迟；
+    // 但不早于最近一次跳转的位置，避免跳转后进度回退
+    long long frame = playedFrames.load(std::memory_order_relaxed) - latencyFrames;
+    frame = std::max(frame, segmentStart.load(std::memory_order_relaxed));
+    return (double)frame / outRate;
+}
+
+double MusicPlayer::getBufferedSeconds() const {
+    if (!audioOpen) return 0.0;
+    return (double)ring.available() / outChannels / outRate;
+}
+
+double MusicPlayer::getBufferSpaceSeconds() const {
+    if (!audioOpen) return 0.0;
+    return (double)ring.space() / outChannels / outRate;
+}
+
+double MusicPlayer::getDecodeRemainingSeconds() const {
+    if (outRate <= 0) return 0.0;
+    long long remaining = trackFrames.load(std::memory_order_relaxed) - decodedFrames.load(std::memory_order_relaxed);
+    return (double)std::max(0LL, remaining) / outRate;
+}
+
+double MusicPlayer::getBufferFill() const {
+    if (ring.capacity() == 0) return 0.0;
+    return (double)ring.available() / ring.capacity();
 }
 
 bool MusicPlayer::seekForward(double seconds) {
-    if (!music) return false;
+    if (!decoder) return false;
     
     // 频率限制：每0.25秒最多1次快进快退
     Uint32 currentTime = SDL_GetTicks();
@@ -164,7 +613,7 @@ bool MusicPlayer::seekForward(double seconds) {
 }
 
 bool MusicPlayer::seekBackward(double seconds) {
-    if (!music) return false;
+    if (!decoder) return false;
     
     // 频率限制：每0.25秒最多1次快进快退
     Uint32 currentTime = SDL_GetTicks();
@@ -187,38 +636,25 @@ bool MusicPlayer::seekBackward(double seconds) {
 }
 
 bool MusicPlayer::seekTo(double position) {
-    if (!music) return false;
+    if (!decoder || !playing) return false;
     
     // 确保位置在有效范围内
     if (position < 0 || position > currentSong.duration) {
         return false;
     }
     
-    // 保存当前播放状态
-    bool wasPlaying = isPlaying() && !isPaused();
-    bool wasPaused = isPaused();
-    
-    // 停止当前播放
-    Mix_HaltMusic();
-    
-    // 从指定位置开始播放
-    int result = Mix_FadeInMusicPos(music, 1, 0, position);
-    
-    if (result == 0) { // 成功
-        // 重新计算开始时间
-        startTicks = SDL_GetTicks() - static_cast<Uint32>(position * 1000);
-        pauseTotalTicks = 0;
-        
-        // 恢复之前的播放状态
-        if (wasPaused) {
-            Mix_PauseMusic();
-            pauseStartTicks = SDL_GetTicks();
+    bool ok;
+    {
+        std::lock_guard<std::mutex> lock(engineMutex);
+        fadingOut.reset(); // 跳转时结束未完成的淡变
+        fadeLength = 0;
+        ok = decoder->seek(position);
+        if (ok) {
+            requestFlush((long long)(position * outRate));
         }
-        
-        return true;
     }
-    
-    return false;
+    decodeCv.notify_one();
+    return ok;
 }
 
 // 音量控制方法实现
@@ -229,20 +665,27 @@ void MusicPlayer::setVolume(int volume) {
     
     currentVolume = volume;
     
-    // 只有在SDL_mixer初始化成功时才设置音量
-    // SDL_mixer的音量范围是0-128，所以需要转换
-    int sdlVolume = (volume * 128) / 100;
-    Mix_VolumeMusic(sdlVolume);
+    // 音量由音频回调中的增益级平滑应用
+    gainStage.setTarget(volume / 100.0f);
 }
 
 void MusicPlayer::increaseVolume() {
-    // 每次增加5%，共20档
-    int newVolume = currentVolume + 5;
+    // 每次增加2%，共50档；增益级负责平滑过渡
+    int newVolume = currentVolume + kVolumeStep;
     setVolume(newVolume);
 }
 
 void MusicPlayer::decreaseVolume() {
-    // 每次减少5%，共20档
-    int newVolume = currentVolume - 5;
+    // 每次减少2%，共50档
+    int newVolume = currentVolume - kVolumeStep;
     setVolume(newVolume);
-}
\ No newline at end of file
+}
+
+void MusicPlayer::setCrossfadeSeconds(int seconds) {
+    crossfadeSeconds = std::max(0, std::min(seconds, kMaxCrossfadeSeconds));
+}
+
+void MusicPlayer::setFinishedCallback(std::function<void()> callback) {
+    std::lock_guard<std::mutex> lock(engineMutex);
+    finishedCallback = std::move(callback);
+}
@@ -0,0 +1,160 @@
+#include "ParametricEq.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+const double kPi = 3.14159265358979323846;
+}
+
+// --- 预设 ---
+std::vector<EqPreset> EqPreset::builtins() {
+    auto peak = [](double f, double g, double q) { return EqBand{EqBandType::PEAK, f, g, q}; };
+    auto low = [](double f, double g) { return EqBand{EqBandType::LOW_SHELF, f, g, 0.707}; };
+    auto high = [](double f, double g) { return EqBand{EqBandType::HIGH_SHELF, f, g, 0.707}; };
+    return {
+        {"平直", 0.0, {}},
+        {"低音增强", -6.0, {low(100, 6.0), peak(250, 1.5, 1.0)}},
+        {"人声", -3.0, {low(120, -2.0), peak(1000, 2.0, 0.8), peak(3000, 3.0, 1.0), high(10000, -1.0)}},
+        {"摇滚", -4.0, {low(80, 4.0), peak(400, -2.0, 1.0), peak(2500, 2.0, 1.0), high(8000, 3.5)}},
+        {"古典", -2.0, {low(60, 2.0), peak(500, -1.0, 0.7), high(12000, 2.0)}},
+        {"流行", -3.0, {low(90, 2.0), peak(800, 1.0, 1.0), peak(2500, 3.0, 1.2), high(12000, 1.5)}},
+    };
+}
+
+const char* EqPreset::typeName(EqBandType type) {
+    switch (type) {
+        case EqBandType::LOW_SHELF: return "low_shelf";
+        case EqBandType::HIGH_SHELF: return "high_shelf";
+        default: return "peak";
+    }
+}
+
+EqBandType EqPreset::parseType(const std::string& name) {
+    if (name == "low_shelf") return EqBandType::LOW_SHELF;
+    if (name == "high_shelf") return EqBandType::HIGH_SHELF;
+    return EqBandType::PEAK;
+}
+
+// --- 滤波器 ---
+ParametricEq::Coeffs ParametricEq::design(const EqBand& band, int sample_rate) {
+    // RBJ Audio EQ Cookbook 公式，频率限制在奈奎斯特频率以下
+    double freq = std::max(10.0, std::min(band.frequency, sample_rate * 0.45));
+    double q = std::max(0.1, band.q);
+    double a = std::pow(10.0, band.gain / 40.0);
+    double w0 = 2.0 * kPi * freq / sample_rate;
+    double cw = std::cos(w0);
+    double alpha = std::sin(w0) / (2.0 * q);
+    double sa = 2.0 * std::sqrt(a) * alpha;
+
+    double b0, b1, b2, a0, a1, a2;
+    switch (band.type) {
+        case EqBandType::LOW_SHELF:
+            b0 = a * ((a + 1) - (a - 1) * cw + sa);
+            b1 = 2 * a * ((a - 1) - (a + 1) * cw);
+            b2 = a * ((a + 1) - (a - 1) * cw - sa);
+            a0 = (a + 1) + (a - 1) * cw + sa;
+            a1 = -2 * ((a - 1) + (a + 1) * cw);
+            a2 = (a + 1) + (a - 1) * cw - sa;
+            break;
+        case EqBandType::HIGH_SHELF:
+            b0 = a * ((a + 1) + (a - 1) * cw + sa);
+            b1 = -2 * a * ((a - 1) + (a + 1) * cw);
+            b2 = a * ((a + 1) + (a - 1) * cw - sa);
+            a0 = (a + 1) - (a - 1) * cw + sa;
+            a1 = 2 * ((a - 1) - (a + 1) * cw);
+            a2 = (a + 1) - (a - 1) * cw - sa;
+            break;
+        default:
+            b0 = 1 + alpha * a;
+            b1 = -2 * cw;
+            b2 = 1 - alpha * a;
+            a0 = 1 + alpha / a;
+            a1 = -2 * cw;
+            a2 = 1 - alpha / a;
+            break;
+    }
+
+    Coeffs c;
+    c.bypass = false;
+    c.b0 = (float)(b0 / a0);
+    c.b1 = (float)(b1 / a0);
+    c.b2 = (float)(b2 / a0);
+    c.a1 = (float)(a1 / a0);
+    c.a2 = (float)(a2 / a0);
+    return c;
+}
+
+void ParametricEq::rebuild() {
+    // 频段与滤波器状态一一对应：0 dB 的频段不影响信号，用直通占位而不是跳过，
+    // 否则调节到 0 dB 时其后频段的状态会错位到相邻频段的系数上，产生爆音
+    pendingCount = std::min((int)bands.size(), kMaxBands);
+    for (int b = 0; b < pendingCount; ++b) {
+        pending[b] = bands[b].gain == 0.0 ? Coeffs() : design(bands[b], sampleRate);
+    }
+    pendingPreamp = (float)std::pow(10.0, preampDb / 20.0);
+    dirty.store(true, std::memory_order_release);
+}
+
+void ParametricEq::setPreset(const EqPreset& preset) {
+    std::lock_guard<std::mutex> lock(paramMutex);
+    bands = preset.bands;
+    preampDb = preset.preamp;
+    rebuild();
+}
+
+void ParametricEq::prepare(int sample_rate, int channel_count) {
+    std::lock_guard<std::mutex> lock(paramMutex);
+    sampleRate = sample_rate;
+    channelCount = std::min(channel_count, kMaxChannels);
+    rebuild();
+
+    // 此时音频回调已停止，可以直接更新回调一侧的状态
+    channels = channelCount;
+    std::copy(pending, pending + pendingCount, active);
+    activeCount = pendingCount;
+    activePreamp = pendingPreamp;
+    dirty.store(false, std::memory_order_relaxed);
+    std::memset(z1, 0, sizeof(z1));
+    std::memset(z2, 0, sizeof(z2));
+}
+
+void ParametricEq::process(float* data, size_t frames) {
+    // 取走新系数；控制线程正持有锁时下一个缓冲区再取
+    if (dirty.load(std::memory_order_acquire) && paramMutex.try_lock()) {
+        // 新增的频段和由直通恢复的频段从零状态开始（直通滤波器的状态本就为零）
+        for (int b = 0; b < pendingCount; ++b) {
+            if (b >= activeCount || active[b].bypass) {
+                for (int g = 0; g < kGroups; ++g) z1[b][g] = z2[b][g] = Lanes{};
+            }
+        }
+        std::copy(pending, pending + pendingCount, active);
+        activeCount = pendingCount;
+        activePreamp = pendingPreamp;
+        dirty.store(false, std::memory_order_relaxed);
+        paramMutex.unlock();
+    }
+    if (activeCount == 0 && activePreamp == 1.0f) return;
+
+    int groups = (channels + 3) / 4;
+    for (size_t i = 0; i < frames; ++i) {
+        float* frame = data + i * channels;
+        for (int g = 0; g < groups; ++g) {
+            // 把最多 4 个声道装入一个向量，所有声道同时通过每个频段
+            int base = g * 4;
+            int lanes = std::min(4, channels - base);
+            Lanes v = {};
+            for (int c = 0; c < lanes; ++c) v[c] = frame[base + c];
+            v *= activePreamp;
+            for (int b = 0; b < activeCount; ++b) {
+                const Coeffs& k = active[b];
+                if (k.bypass) continue;
+                Lanes y = k.b0 * v + z1[b][g];
+                z1[b][g] = k.b1 * v - k.a1 * y + z2[b][g];
+                z2[b][g] = k.b2 * v - k.a2 * y;
+                v = y;
+            }
+            for (int c = 0; c < lanes; ++c) frame[base + c] = v[c];
+        }
+    }
+}
@@ -0,0 +1,221 @@
+#include "PersistenceWriter.hpp"
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+
+constexpr std::chrono::milliseconds PersistenceWriter::kQuietPeriod;
+constexpr std::chrono::milliseconds PersistenceWriter::kMaxDelay;
+constexpr std::chrono::milliseconds PersistenceWriter::kMaxRetryDelay;
+
+PersistenceWriter::PersistenceWriter() {
+    thread = std::thread(&PersistenceWriter::worker, this);
+}
+
+PersistenceWriter::~PersistenceWriter() {
+    flush();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    cv.notify_all();
+    if (thread.joinable()) thread.join();
+}
+
+void PersistenceWriter::markDirty(const std::string& key, SnapshotFn snapshot) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto now = std::chrono::steady_clock::now();
+        if (pending.empty()) firstDirty = now;
+        lastDirty = now;
+        retries.erase(key); // 新的快照函数取代等待重试的旧函数
+        auto it = pending.find(key);
+        if (it != pending.end()) {
+            it->second = std::move(snapshot);
+        } else {
+            pending.emplace(key, std::move(snapshot));
+            order.push_back(key);
+        }
+    }
+    cv.notify_all();
+}
+
+void PersistenceWriter::flush() {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (pending.empty() && retries.empty() && !busy) return;
+    flushRequested = true;
+    cv.notify_all();
+    // 等待的重试也立即再试一次；仍然失败的留待之后重试，不在这里等待
+    doneCv.wait(lock, [this]() { return !flushRequested && pending.empty() && !busy; });
+}
+
+void PersistenceWriter::pause() {
+    std::unique_lock<std::mutex> lock(mutex);
+    ++pauseCount;
+    doneCv.wait(lock, [this]() { return !busy; });
+}
+
+void PersistenceWriter::resume() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        --pauseCount;
+    }
+    cv.notify_all();
+}
+
+void PersistenceWriter::worker() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        // 到期的重试并入待写列表；flush 时不等退避间隔，立即再试一次
+        auto now = std::chrono::steady_clock::now();
+        auto next_retry = std::chrono::steady_clock::time_point::max();
+        for (auto it = retries.begin(); it != retries.end();) {
+            if (flushRequested || it->second.due <= now) {
+                if (pending.empty()) firstDirty = lastDirty = now;
+                pending.emplace(it->first, std::move(it->second.snapshot));
+                order.push_back(it->first);
+                it = retries.erase(it);
+            } else {
+                next_retry = std::min(next_retry, it->second.due);
+                ++it;
+            }
+        }
+
+        if (pending.empty() || (pauseCount > 0 && !stopping)) {
+            if (pending.empty() && flushRequested) {
+                flushRequested = false; // 没有需要写出的内容，flush 完成
+                doneCv.notify_all();
+            }
+            if (stopping && pending.empty()) return; // 没有待写内容（放弃仍在等待的重试）
+            if (next_retry == std::chrono::steady_clock::time_point::max() || pauseCount > 0) {
+                cv.wait(lock);
+            } else {
+                cv.wait_until(lock, next_retry);
+            }
+            continue;
+        }
+
+        // 等到一段时间内没有新的修改，或者距第一次修改已超过上限
+        while (!flushRequested && !stopping) {
+            auto deadline = std::min(lastDirty + kQuietPeriod, firstDirty + kMaxDelay);
+            if (std::chrono::steady_clock::now() >= deadline) break;
+            cv.wait_until(lock, deadline);
+        }
+        if (pauseCount > 0 && !stopping) continue; // 等待期间被暂停
+
+        std::unordered_map<std::string, SnapshotFn> batch;
+        batch.swap(pending);
+        std::vector<std::string> keys;
+        keys.swap(order);
+        flushRequested = false;
+        busy = true;
+        lock.unlock();
+
+        std::vector<std::string> succeeded;
+        std::vector<std::string> failed;
+        for (const auto& key : keys) {
+            PersistTask task;
+            bool ok = true;
+            try {
+                // 快照函数自行加锁复制数据，序列化和写盘都在锁外进行
+                if (!batch[key](task) || task.path.empty()) continue;
+                std::error_code ec;
+                if (task.serialize) {
+                    std::string data = task.serialize();
+                    ok = task.append ? appendDurably(task.path, data) : writeAtomically(task.path, data);
+                    if (ok) writeCount.fetch_add(1, std::memory_order_relaxed);
+                } else {
+                    fs::remove(task.path, ec);
+                    ok = !ec;
+                }
+                if (ok) {
+                    for (const auto& file : task.obsolete) fs::remove(file, ec);
+                }
+            } catch (...) {
+                ok = false;
+            }
+            if (ok) {
+                succeeded.push_back(key);
+            } else {
+                try {
+                    if (task.failed) task.failed();
+                } catch (...) {}
+                failed.push_back(key);
+            }
+        }
+
+        lock.lock();
+        for (const auto& key : succeeded) failureCounts.erase(key);
+        // 失败的键按退避间隔用同一个快照函数重试（快照函数会重新读取当时的数据）；
+        // 写出期间又被标记的键已有新的快照函数，照常写出
+        now = std::chrono::steady_clock::now();
+        for (const auto& key : failed) {
+            int failures = ++failureCounts[key];
+            if (stopping || pending.count(key)) continue;
+            auto delay = std::min<std::chrono::milliseconds>(kMaxRetryDelay, kQuietPeriod * (1 << std::min(failures - 1, 8)));
+            retries[key] = Retry{std::move(batch[key]), now + delay};
+        }
+        busy = false;
+        doneCv.notify_all();
+    }
+}
+
+namespace {
+// 写入全部内容，失败时返回 false
+bool writeAll(int fd, const std::string& data) {
+    const char* p = data.data();
+    size_t remaining = data.size();
+    while (remaining > 0) {
+        ssize_t n = ::write(fd, p, remaining);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        p += n;
+        remaining -= (size_t)n;
+    }
+    return true;
+}
+}
+
+void PersistenceWriter::syncDirectory(const fs::path& path) {
+    int dir = ::open(path.parent_path().empty() ? "." : path.parent_path().c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dir >= 0) {
+        ::fsync(dir);
+        ::close(dir);
+    }
+}
+
+bool PersistenceWriter::writeAtomically(const fs::path& path, const std::string& data) {
+    fs::path tmp = path;
+    tmp += ".tmp";
+    int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) return false;
+    if (!writeAll(fd, data)) {
+        ::close(fd);
+        ::unlink(tmp.c_str());
+        return false;
+    }
+    // 先把数据落盘再替换，崩溃时要么是旧文件要么是完整的新文件
+    if (::fsync(fd) != 0 || ::close(fd) != 0) {
+        ::unlink(tmp.c_str());
+        return false;
+    }
+    if (::rename(tmp.c_str(), path.c_str()) != 0) {
+        ::unlink(tmp.c_str());
+        return false;
+    }
+    syncDirectory(path);
+    return true;
+}
+
+bool PersistenceWriter::appendDurably(const fs::path& path, const std::string& data) {
+    std::error_code ec;
+    bool created = !fs::exists(path, ec);
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0) return false;
+    // 写到一半时崩溃留下的不完整记录由读取方按校验和丢弃
+    bool ok = writeAll(fd, data) && ::fdatasync(fd) == 0;
+    if (::close(fd) != 0) ok = false;
+    if (ok && created) syncDirectory(path);
+    return ok;
+}
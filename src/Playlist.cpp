@@ -1,17 +1,18 @@
 #include "Playlist.hpp"
-#include <taglib/fileref.h>
-#include <taglib/tag.h>
-#include <taglib/mpegfile.h>
-#include <taglib/flacfile.h>
-#include <taglib/id3v2tag.h>
-#include <taglib/xiphcomment.h>
+#include "TagCache.hpp"
+#include "MetadataExtractor.hpp"
 #include <iostream>
 #include <fstream>
 
 void SongEntry::loadMetadata() {
-    // 获取文件修改时间
+    // 获取文件修改时间和大小（作为标签缓存的键）
+    std::error_code ec;
+    std::uintmax_t file_size = fs::file_size(path, ec);
+    if (ec) file_size = 0;
+    std::int64_t mtime_key = 0;
     try {
         auto ftime = fs::last_write_time(path);
+        mtime_key = ftime.time_since_epoch().count();
         // 使用更兼容的方式处理文件时间
         auto sctp = std::chrono::time_point_cast<std::chrono::system_clock::duration>(
             ftime - fs::file_time_type::clock::now() + std::chrono::system_clock::now());
@@ -23,13 +24,25 @@ void SongEntry::loadMetadata() {
     // 获取文件名（备用）
     std::string filename = fs::path(path).filename().string();
     
+    // 文件未变化时直接使用缓存，不再打开文件
+    CachedTags cached;
+    if (mtime_key != 0 && TagCache::instance().lookup(path, file_size, mtime_key, cached)) {
+        title = cached.title;
+        artist = cached.artist;
+        album = cached.album;
+        duration = cached.duration;
+        track_number = cached.track_number;
+        return;
+    }
+    
     // 使用 TagLib 获取元数据
-    TagLib::FileRef file(path.c_str());
-    if (!file.isNull() && file.tag()) {
-        TagLib::Tag* tag = file.tag();
-        title = tag->title().toCString(true);
-        artist = tag->artist().toCString(true);
-        album = tag->album().toCString(true);
+    TrackMetadata meta;
+    if (MetadataExtractor::extract(path, meta)) {
+        title = meta.title;
+        artist = meta.artist;
+        album = meta.album;
+        track_number = meta.track_number;
+        duration = meta.duration;
         
         // 如果元数据为空，使用文件名
         if (title.empty()) title = filename;
@@ -41,6 +54,17 @@ void SongEntry::loadMetadata() {
         artist = "未知艺术家";
         album = "未知专辑";
     }
+    
+    if (mtime_key != 0) {
+        cached.size = file_size;
+        cached.mtime = mtime_key;
+        cached.title = title;
+        cached.artist = artist;
+        cached.album = album;
+        cached.duration = duration;
+        cached.track_number = track_number;
+        TagCache::instance().store(path, cached);
+    }
 }
 
 json SongEntry::toJson() const {
@@ -50,6 +74,8 @@ json SongEntry::toJson() const {
     j["artist"] = artist;
     j["album"] = album;
     j["modified_time"] = modified_time;
+    j["duration"] = duration;
+    j["track_number"] = track_number;
     return j;
 }
 
@@ -60,6 +86,8 @@ SongEntry SongEntry::fromJson(const json& j) {
     song.artist = j.value("artist", "");
     song.album = j.value("album", "");
     song.modified_time = j.value("modified_time", 0);
+    song.duration = j.value("duration", 0);
+    song.track_number = j.value("track_number", 0);
     return song;
 }
 
@@ -77,6 +105,7 @@ void Playlist::addSong(const std::string& path) {
     SongEntry song;
     song.path = path;
     song.loadMetadata();
+    pathIndex.emplace(song.path, songs.size());
     songs.push_back(song);
     modified_time = std::chrono::system_clock::to_time_t(
         std::chrono::system_clock::now());
@@ -86,48 +115,100 @@ void Playlist::addSong(const SongEntry& song) {
     if (containsSong(song.path)) {
         return; // 避免重复添加
     }
+    pathIndex.emplace(song.path, songs.size());
     songs.push_back(song);
     modified_time = std::chrono::system_clock::to_time_t(
         std::chrono::system_clock::now());
 }
 
+size_t Playlist::addSongs(const std::vector<SongEntry>& new_songs) {
+    size_t added = 0;
+    songs.reserve(songs.size() + new_songs.size());
+    pathIndex.reserve(songs.size() + new_songs.size());
+    for (const auto& song : new_songs) {
+        // emplace 同时完成查重和登记
+        if (!pathIndex.emplace(song.path, songs.size()).second) {
+            continue; // 避免重复添加
+        }
+        songs.push_back(song);
+        added++;
+    }
+    if (added > 0) {
+        modified_time = std::chrono::system_clock::to_time_t(
+            std::chrono::system_clock::now());
+    }
+    return added;
+}
+
 void Playlist::removeSong(int index) {
     if (index >= 0 && index < (int)songs.size()) {
+        pathIndex.erase(songs[index].path);
         songs.erase(songs.begin() + index);
+        reindex(index); // 后面的歌曲位置前移一位
         modified_time = std::chrono::system_clock::to_time_t(
             std::chrono::system_clock::now());
     }
 }
 
 bool Playlist::containsSong(const std::string& path) const {
-    return std::any_of(songs.begin(), songs.end(),
-        [&path](const SongEntry& song) { return song.path == path; });
+    return pathIndex.count(path) > 0;
 }
 
-void Playlist::sort(SortBy by, SortOrder order) {
-    std::sort(songs.begin(), songs.end(), [by, order](const SongEntry& a, const SongEntry& b) {
-        bool less_than = false;
-        
+int Playlist::indexOf(const std::string& path) const {
+    auto it = pathIndex.find(path);
+    return it == pathIndex.end() ? -1 : (int)it->second;
+}
+
+void Playlist::reindex(size_t from) {
+    if (from == 0) {
+        pathIndex.clear();
+        pathIndex.reserve(songs.size());
+    }
+    for (size_t i = from; i < songs.size(); ++i) {
+        pathIndex[songs[i].path] = i;
+    }
+}
+
+void Playlist::sort(SortBy by, SortOrder order, std::vector<uint32_t>* permutation) {
+    auto less = [by](const SongEntry& a, const SongEntry& b) {
         switch (by) {
             case SortBy::TITLE:
-                less_than = a.title < b.title;
-                break;
+                return a.title < b.title;
             case SortBy::ARTIST:
-                less_than = a.artist < b.artist;
-                break;
+                return a.artist < b.artist;
             case SortBy::ALBUM:
-                less_than = a.album < b.album;
-                break;
+                return a.album < b.album;
             case SortBy::FILENAME:
-                less_than = fs::path(a.path).filename().string() < fs::path(b.path).filename().string();
-                break;
+                return fs::path(a.path).filename().string() < fs::path(b.path).filename().string();
             case SortBy::MODIFIED_TIME:
-                less_than = a.modified_time < b.modified_time;
-                break;
+                return a.modified_time < b.modified_time;
         }
-        
-        return (order == SortOrder::ASCENDING) ? less_than : !less_than;
+        return false;
+    };
+    
+    // 对位置排序，得到的排列可以写入修改日志；降序时交换参数，保持严格弱序
+    std::vector<uint32_t> indices(songs.size());
+    for (size_t i = 0; i < indices.size(); ++i) indices[i] = (uint32_t)i;
+    std::sort(indices.begin(), indices.end(), [&](uint32_t a, uint32_t b) {
+        return order == SortOrder::ASCENDING ? less(songs[a], songs[b]) : less(songs[b], songs[a]);
     });
+    applyOrder(indices);
+    if (permutation) *permutation = std::move(indices);
+}
+
+bool Playlist::applyOrder(const std::vector<uint32_t>& order) {
+    if (order.size() != songs.size()) return false;
+    std::vector<bool> seen(songs.size(), false);
+    for (uint32_t index : order) {
+        if (index >= songs.size() || seen[index]) return false;
+        seen[index] = true;
+    }
+    std::vector<SongEntry> sorted;
+    sorted.reserve(songs.size());
+    for (uint32_t index : order) sorted.push_back(std::move(songs[index]));
+    songs.swap(sorted);
+    reindex();
+    return true;
 }
 
 json Playlist::toJson() const {
@@ -135,6 +216,7 @@ json Playlist::toJson() const {
     j["name"] = name;
     j["created_time"] = created_time;
     j["modified_time"] = modified_time;
+    j["revision"] = revision;
     
     json songs_json = json::array();
     for (const auto& song : songs) {
@@ -149,12 +231,15 @@ Playlist Playlist::fromJson(const json& j) {
     Playlist playlist(j.value("name", "未命名歌单"));
     playlist.created_time = j.value("created_time", 0);
     playlist.modified_time = j.value("modified_time", 0);
+    playlist.revision = j.value("revision", (uint64_t)0);
     
     if (j.contains("songs") && j["songs"].is_array()) {
+        playlist.songs.reserve(j["songs"].size());
         for (const auto& song_json : j["songs"]) {
             playlist.songs.push_back(SongEntry::fromJson(song_json));
         }
     }
+    playlist.reindex();
     
     return playlist;
 }
\ No newline at end of file
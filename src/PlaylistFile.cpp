@@ -0,0 +1,698 @@
+#include "PlaylistFile.hpp"
+#include "PersistenceWriter.hpp"
+#include "PlaylistJournal.hpp"
+#include "TextLayout.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <ostream>
+#include <unordered_map>
+#include <fcntl.h>
+#include <malloc.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+constexpr uint32_t PlaylistFile::kVersion;
+constexpr uint32_t PlaylistFile::kHeaderSizeV1;
+constexpr const char* PlaylistFile::kBinaryExtension;
+constexpr const char* PlaylistFile::kJsonExtension;
+
+namespace {
+const char kMagic[4] = {'S', 'M', 'P', 'L'};
+
+// 只读映射整个文件，失败或文件小于 min_size 时返回 nullptr
+void* mapFile(const fs::path& path, size_t min_size, size_t& size) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return nullptr;
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size <= 0 || (size_t)st.st_size < min_size) {
+        ::close(fd);
+        return nullptr;
+    }
+    size = (size_t)st.st_size;
+    void* data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) return nullptr;
+    ::madvise(data, size, MADV_SEQUENTIAL);
+    return data;
+}
+
+// 追加字符串到字符串表，相同内容只存一份
+class StringTable {
+public:
+    explicit StringTable(std::string& out) : out(out) {}
+
+    void add(std::string_view text, uint32_t& offset, uint32_t& length) {
+        auto it = offsets.find(text);
+        if (it != offsets.end()) {
+            offset = it->second;
+        } else {
+            offset = (uint32_t)(out.size() - base);
+            offsets.emplace(text, offset);
+            out.append(text.data(), text.size());
+        }
+        length = (uint32_t)text.size();
+    }
+
+    void setBase() { base = out.size(); }
+    size_t size() const { return out.size() - base; }
+
+private:
+    std::string& out;
+    size_t base = 0;
+    std::unordered_map<std::string_view, uint32_t> offsets; // 指向原歌单中的字符串
+};
+
+// SAX 解析状态：只认识顶层的 name/created_time/modified_time/songs 和歌曲的各个字段，
+// 其他键和更深的嵌套内容直接跳过；字符串从解析器的缓冲区移动到 SongEntry 中，不再复制
+class PlaylistSax {
+public:
+    using number_integer_t = json::number_integer_t;
+    using number_unsigned_t = json::number_unsigned_t;
+    using number_float_t = json::number_float_t;
+    using string_t = json::string_t;
+    using binary_t = json::binary_t;
+
+    explicit PlaylistSax(Playlist& playlist, std::vector<SongEntry>& songs) : playlist(playlist), songs(songs) {}
+
+    bool null() { return true; }
+    bool boolean(bool) { return true; }
+    bool number_integer(number_integer_t value) { return number((int64_t)value); }
+    bool number_unsigned(number_unsigned_t value) {
+        if (target() == Field::REVISION) {
+            playlist.revision = value; // 避免超过 int64 范围时被截断
+            return true;
+        }
+        return number((int64_t)value);
+    }
+    bool number_float(number_float_t value, const string_t&) { return number((int64_t)value); }
+    bool binary(binary_t&) { return true; }
+
+    bool string(string_t& value) {
+        switch (target()) {
+            case Field::NAME: playlist.name = std::move(value); break;
+            case Field::PATH: songs.back().path = std::move(value); break;
+            case Field::TITLE: songs.back().title = std::move(value); break;
+            case Field::ARTIST: songs.back().artist = std::move(value); break;
+            case Field::ALBUM: songs.back().album = std::move(value); break;
+            default: break;
+        }
+        return true;
+    }
+
+    bool start_object(std::size_t) {
+        if (depth == 0) {
+            topLevelObject = true;
+        } else if (inSongs && depth == 2) {
+            songs.emplace_back();
+            songs.back().modified_time = 0;
+            inSong = true;
+        }
+        ++depth;
+        return true;
+    }
+
+    bool end_object() {
+        --depth;
+        if (inSong && depth == 2) inSong = false;
+        return true;
+    }
+
+    bool start_array(std::size_t) {
+        if (depth == 1 && topField == Field::SONGS) inSongs = true;
+        ++depth;
+        return true;
+    }
+
+    bool end_array() {
+        --depth;
+        if (inSongs && depth == 1) inSongs = false;
+        return true;
+    }
+
+    bool key(string_t& name) {
+        if (depth == 1) {
+            topField = name == "name" ? Field::NAME
+                     : name == "created_time" ? Field::CREATED
+                     : name == "modified_time" ? Field::MODIFIED
+                     : name == "revision" ? Field::REVISION
+                     : name == "songs" ? Field::SONGS
+                     : Field::NONE;
+        } else if (inSong && depth == 3) {
+            songField = name == "path" ? Field::PATH
+                      : name == "title" ? Field::TITLE
+                      : name == "artist" ? Field::ARTIST
+                      : name == "album" ? Field::ALBUM
+                      : name == "modified_time" ? Field::SONG_MODIFIED
+                      : name == "duration" ? Field::DURATION
+                      : name == "track_number" ? Field::TRACK
+                      : Field::NONE;
+        }
+        return true;
+    }
+
+    bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception&) { return false; }
+
+    bool isTopLevelObject() const { return topLevelObject; }
+
+private:
+    enum class Field { NONE, NAME, CREATED, MODIFIED, REVISION, SONGS, PATH, TITLE, ARTIST, ALBUM, SONG_MODIFIED, DURATION, TRACK };
+
+    // 当前值要写入的字段
+    Field target() const {
+        if (depth == 1) return topField;
+        if (inSong && depth == 3) return songField;
+        return Field::NONE;
+    }
+
+    bool number(int64_t value) {
+        switch (target()) {
+            case Field::CREATED: playlist.created_time = (std::time_t)value; break;
+            case Field::MODIFIED: playlist.modified_time = (std::time_t)value; break;
+            case Field::REVISION: playlist.revision = (uint64_t)value; break;
+            case Field::SONG_MODIFIED: songs.back().modified_time = (std::time_t)value; break;
+            case Field::DURATION: songs.back().duration = (int)value; break;
+            case Field::TRACK: songs.back().track_number = (int)value; break;
+            default: break;
+        }
+        return true;
+    }
+
+    Playlist& playlist;
+    std::vector<SongEntry>& songs;
+    int depth = 0;
+    bool topLevelObject = false;
+    bool inSongs = false;
+    bool inSong = false;
+    Field topField = Field::NONE;
+    Field songField = Field::NONE;
+};
+
+// 合法 UTF-8 序列的长度（与 nlohmann 解析器的规则一致，拒绝过长编码和代理区），不合法时返回 0
+size_t utf8Length(const unsigned char* p, size_t available) {
+    unsigned char c = p[0];
+    size_t length;
+    unsigned char low = 0x80;
+    unsigned char high = 0xBF;
+    if (c >= 0xC2 && c <= 0xDF) {
+        length = 2;
+    } else if (c >= 0xE0 && c <= 0xEF) {
+        length = 3;
+        if (c == 0xE0) low = 0xA0;
+        if (c == 0xED) high = 0x9F;
+    } else if (c >= 0xF0 && c <= 0xF4) {
+        length = 4;
+        if (c == 0xF0) low = 0x90;
+        if (c == 0xF4) high = 0x8F;
+    } else {
+        return 0;
+    }
+    if (length > available || p[1] < low || p[1] > high) return 0;
+    for (size_t i = 2; i < length; ++i) {
+        if ((p[i] & 0xC0) != 0x80) return 0;
+    }
+    return length;
+}
+
+// 按 nlohmann dump() 的规则输出带引号的字符串；不合法的 UTF-8 字节替换为 U+FFFD
+void appendString(std::string& out, std::string_view text) {
+    static const char hex[] = "0123456789abcdef";
+    out += '"';
+    const unsigned char* p = (const unsigned char*)text.data();
+    size_t size = text.size();
+    size_t i = 0;
+    while (i < size) {
+        unsigned char c = p[i];
+        if (c >= 0x80) {
+            size_t length = utf8Length(p + i, size - i);
+            if (length == 0) {
+                out += "\xEF\xBF\xBD";
+                ++i;
+            } else {
+                out.append((const char*)p + i, length);
+                i += length;
+            }
+            continue;
+        }
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\b': out += "\\b"; break;
+            case '\f': out += "\\f"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (c < 0x20) {
+                    out += "\\u00";
+                    out += hex[c >> 4];
+                    out += hex[c & 0xF];
+                } else {
+                    out += (char)c;
+                }
+                break;
+        }
+        ++i;
+    }
+    out += '"';
+}
+
+void appendField(std::string& out, const char* indent, const char* key, std::string_view value, bool last = false) {
+    out += indent;
+    out += key;
+    appendString(out, value);
+    out += last ? "\n" : ",\n";
+}
+
+void appendField(std::string& out, const char* indent, const char* key, int64_t value, bool last = false) {
+    out += indent;
+    out += key;
+    out += std::to_string(value);
+    out += last ? "\n" : ",\n";
+}
+
+void appendField(std::string& out, const char* indent, const char* key, uint64_t value, bool last = false) {
+    out += indent;
+    out += key;
+    out += std::to_string(value);
+    out += last ? "\n" : ",\n";
+}
+}
+
+// --- PlaylistView ---
+PlaylistView::~PlaylistView() {
+    close();
+}
+
+void PlaylistView::close() {
+    if (mapping) ::munmap(mapping, mappingSize);
+    mapping = nullptr;
+    mappingSize = 0;
+    header = PlaylistFileHeader{};
+    records = nullptr;
+    strings = nullptr;
+}
+
+bool PlaylistView::open(const fs::path& path) {
+    close();
+    size_t size = 0;
+    void* data = mapFile(path, sizeof(PlaylistFileHeader), size);
+    if (!data) return false;
+
+    const char* base = (const char*)data;
+    // 版本 1 的文件头没有 revision，按各版本的长度复制
+    PlaylistFileHeader h{};
+    std::memcpy(&h, base, PlaylistFile::kHeaderSizeV1);
+    size_t header_size = h.version == 1 ? PlaylistFile::kHeaderSizeV1 : sizeof(PlaylistFileHeader);
+    bool valid = std::memcmp(h.magic, kMagic, sizeof(kMagic)) == 0 &&
+                 (h.version == 1 || h.version == PlaylistFile::kVersion) && h.headerSize == header_size &&
+                 size >= header_size;
+    if (valid) {
+        std::memcpy(&h, base, header_size);
+        // 校验各段边界（先比较数量再相乘，避免溢出）
+        valid = h.recordSize == sizeof(PlaylistFileRecord) &&
+                h.count <= (size - header_size) / sizeof(PlaylistFileRecord) &&
+                h.stringsSize == size - header_size - h.count * sizeof(PlaylistFileRecord) &&
+                (uint64_t)h.nameOffset + h.nameLength <= h.stringsSize;
+    }
+    if (valid) {
+        valid = PlaylistFile::checksum(base + header_size, size - header_size) == h.checksum;
+    }
+    const PlaylistFileRecord* r = (const PlaylistFileRecord*)(base + header_size);
+    for (uint64_t i = 0; valid && i < h.count; ++i) {
+        const PlaylistFileRecord& rec = r[i];
+        valid = (uint64_t)rec.pathOffset + rec.pathLength <= h.stringsSize &&
+                (uint64_t)rec.titleOffset + rec.titleLength <= h.stringsSize &&
+                (uint64_t)rec.artistOffset + rec.artistLength <= h.stringsSize &&
+                (uint64_t)rec.albumOffset + rec.albumLength <= h.stringsSize;
+    }
+    if (!valid) {
+        ::munmap(data, size);
+        return false;
+    }
+
+    mapping = data;
+    mappingSize = size;
+    header = h;
+    records = r;
+    strings = base + header_size + h.count * sizeof(PlaylistFileRecord);
+    return true;
+}
+
+std::string_view PlaylistView::name() const {
+    return isOpen() ? string(header.nameOffset, header.nameLength) : std::string_view();
+}
+
+SongView PlaylistView::song(size_t index) const {
+    const PlaylistFileRecord& r = records[index];
+    SongView s;
+    s.path = string(r.pathOffset, r.pathLength);
+    s.title = string(r.titleOffset, r.titleLength);
+    s.artist = string(r.artistOffset, r.artistLength);
+    s.album = string(r.albumOffset, r.albumLength);
+    s.modified_time = (std::time_t)r.modifiedTime;
+    s.duration = r.duration;
+    s.track_number = r.trackNumber;
+    return s;
+}
+
+// --- PlaylistFile ---
+uint64_t PlaylistFile::checksum(const char* data, size_t size) {
+    uint64_t hash = 14695981039346656037ULL;
+    const uint64_t prime = 1099511628211ULL;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, data + i, 8);
+        hash = (hash ^ word) * prime;
+    }
+    for (; i < size; ++i) hash = (hash ^ (unsigned char)data[i]) * prime;
+    return hash;
+}
+
+std::string PlaylistFile::encode(const Playlist& playlist) {
+    const auto& songs = playlist.getSongs();
+    size_t records_size = songs.size() * sizeof(PlaylistFileRecord);
+    std::string out(sizeof(PlaylistFileHeader) + records_size, '\0');
+    StringTable table(out);
+    table.setBase();
+
+    PlaylistFileHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.headerSize = sizeof(PlaylistFileHeader);
+    header.recordSize = sizeof(PlaylistFileRecord);
+    header.count = songs.size();
+    header.createdTime = (int64_t)playlist.created_time;
+    header.modifiedTime = (int64_t)playlist.modified_time;
+    header.revision = playlist.revision;
+    table.add(playlist.name, header.nameOffset, header.nameLength);
+
+    // out 追加字符串时可能重新分配，记录先写到临时对象再拷入
+    for (size_t i = 0; i < songs.size(); ++i) {
+        const SongEntry& song = songs[i];
+        PlaylistFileRecord r{};
+        table.add(song.path, r.pathOffset, r.pathLength);
+        table.add(song.title, r.titleOffset, r.titleLength);
+        table.add(song.artist, r.artistOffset, r.artistLength);
+        table.add(song.album, r.albumOffset, r.albumLength);
+        r.modifiedTime = (int64_t)song.modified_time;
+        r.duration = song.duration;
+        r.trackNumber = song.track_number;
+        std::memcpy(&out[sizeof(PlaylistFileHeader) + i * sizeof(PlaylistFileRecord)], &r, sizeof(r));
+    }
+
+    header.stringsSize = table.size();
+    header.checksum = checksum(out.data() + sizeof(PlaylistFileHeader), out.size() - sizeof(PlaylistFileHeader));
+    std::memcpy(&out[0], &header, sizeof(header));
+    return out;
+}
+
+Playlist PlaylistFile::decode(const PlaylistView& view) {
+    Playlist playlist;
+    playlist.name = std::string(view.name());
+    playlist.created_time = view.createdTime();
+    playlist.modified_time = view.modifiedTime();
+    playlist.revision = view.revision();
+    playlist.songs.resize(view.size());
+    for (size_t i = 0; i < view.size(); ++i) {
+        SongView s = view.song(i);
+        SongEntry& song = playlist.songs[i];
+        song.path.assign(s.path);
+        song.title.assign(s.title);
+        song.artist.assign(s.artist);
+        song.album.assign(s.album);
+        song.modified_time = s.modified_time;
+        song.duration = s.duration;
+        song.track_number = s.track_number;
+    }
+    playlist.reindex();
+    return playlist;
+}
+
+bool PlaylistFile::parseJson(const char* data, size_t size, Playlist& out) {
+    Playlist playlist;
+    playlist.name = "未命名歌单";
+    playlist.created_time = 0;
+    playlist.modified_time = 0;
+    PlaylistSax sax(playlist, playlist.songs);
+    if (!json::sax_parse(data, data + size, &sax) || !sax.isTopLevelObject()) return false;
+    playlist.reindex();
+    out = std::move(playlist);
+    return true;
+}
+
+void PlaylistFile::writeJson(const Playlist& playlist, std::string& out) {
+    // 键按字母顺序输出，与 nlohmann::json（std::map）的 dump(4) 一致
+    const auto& songs = playlist.getSongs();
+    // 预估输出大小（字段名、缩进和数字约 260 字节/首），避免扩容时复制整个缓冲区
+    size_t estimate = 128 + playlist.name.size();
+    for (const auto& song : songs) {
+        estimate += 260 + song.path.size() + song.title.size() + song.artist.size() + song.album.size();
+    }
+    out.clear();
+    out.reserve(estimate);
+    out += "{\n";
+    appendField(out, "    ", "\"created_time\": ", (int64_t)playlist.created_time);
+    appendField(out, "    ", "\"modified_time\": ", (int64_t)playlist.modified_time);
+    appendField(out, "    ", "\"name\": ", playlist.name);
+    appendField(out, "    ", "\"revision\": ", playlist.revision);
+    out += "    \"songs\": ";
+    if (songs.empty()) {
+        out += "[]\n}";
+        return;
+    }
+    out += "[\n";
+    for (size_t i = 0; i < songs.size(); ++i) {
+        const SongEntry& song = songs[i];
+        const char* indent = "            ";
+        out += "        {\n";
+        appendField(out, indent, "\"album\": ", song.album);
+        appendField(out, indent, "\"artist\": ", song.artist);
+        appendField(out, indent, "\"duration\": ", (int64_t)song.duration);
+        appendField(out, indent, "\"modified_time\": ", (int64_t)song.modified_time);
+        appendField(out, indent, "\"path\": ", song.path);
+        appendField(out, indent, "\"title\": ", song.title);
+        appendField(out, indent, "\"track_number\": ", (int64_t)song.track_number, true);
+        out += i + 1 < songs.size() ? "        },\n" : "        }\n";
+    }
+    out += "    ]\n}";
+}
+
+bool PlaylistFile::load(const fs::path& path, Playlist& out) {
+    try {
+        if (path.extension() == kBinaryExtension) {
+            PlaylistView view;
+            if (!view.open(path)) return false;
+            out = decode(view);
+            return true;
+        }
+        size_t size = 0;
+        void* data = mapFile(path, 1, size);
+        if (!data) return false;
+        bool ok = parseJson((const char*)data, size, out);
+        ::munmap(data, size);
+        return ok;
+    } catch (...) {
+        return false;
+    }
+}
+
+std::string PlaylistFile::serialize(const Playlist& playlist, const fs::path& path) {
+    if (path.extension() == kBinaryExtension) return encode(playlist);
+    std::string out;
+    writeJson(playlist, out);
+    return out;
+}
+
+bool PlaylistFile::convert(const fs::path& from, const fs::path& to) {
+    Playlist playlist;
+    if (!load(from, playlist)) return false;
+    return PersistenceWriter::writeAtomically(to, serialize(playlist, to));
+}
+
+namespace {
+struct Measurement {
+    double ms = 0.0;
+    double peakMb = 0.0; // 运行期间常驻内存峰值相对开始时的增量
+};
+
+// 读取 /proc/self/status 中的某一项（单位 KB）
+long readStatusKb(const char* field) {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    size_t length = std::strlen(field);
+    while (std::getline(status, line)) {
+        if (line.compare(0, length, field) == 0 && line.size() > length && line[length] == ':') {
+            return std::atol(line.c_str() + length + 1);
+        }
+    }
+    return 0;
+}
+
+// 在子进程中运行 iterations 次 fn，结果经管道传回，各项测试的堆互不影响。
+// 子进程先归还空闲堆页并重置峰值（clear_refs 5），再以 VmHWM - VmRSS 作为峰值增量
+// 子进程中还会用到 malloc 和 iostream，只能在单线程进程中调用（main 在构造控制器之前运行测试）
+template <typename Fn>
+Measurement measureInChild(Fn fn, int iterations) {
+    Measurement result;
+    int fds[2];
+    if (::pipe(fds) != 0) return result;
+    pid_t pid = ::fork();
+    if (pid == 0) {
+        ::close(fds[0]);
+        ::malloc_trim(0);
+        {
+            std::ofstream clear("/proc/self/clear_refs");
+            clear << "5";
+        }
+        long start_kb = readStatusKb("VmRSS");
+        auto start = std::chrono::steady_clock::now();
+        for (int it = 0; it < iterations; ++it) fn();
+        Measurement m;
+        m.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / iterations;
+        m.peakMb = std::max(0L, readStatusKb("VmHWM") - start_kb) / 1024.0;
+        ssize_t written = ::write(fds[1], &m, sizeof(m));
+        (void)written;
+        ::_exit(0);
+    }
+    ::close(fds[1]);
+    if (pid > 0) {
+        if (::read(fds[0], &result, sizeof(result)) != (ssize_t)sizeof(result)) result = Measurement();
+        int status = 0;
+        ::waitpid(pid, &status, 0);
+    }
+    ::close(fds[0]);
+    return result;
+}
+}
+
+void PlaylistFile::benchmark(std::ostream& out) {
+    // 生成十万首歌：同一专辑的歌手和专辑名重复，路径和标题各不相同
+    const int kSongs = 100000;
+    Playlist playlist("性能测试");
+    {
+        std::vector<SongEntry> songs(kSongs);
+        for (int i = 0; i < kSongs; ++i) {
+            SongEntry& s = songs[i];
+            int album = i / 12;
+            s.artist = "歌手 Artist " + std::to_string(album / 8);
+            s.album = "专辑 \"Album\" " + std::to_string(album);
+            s.title = "第 " + std::to_string(i % 12 + 1) + " 首 Track\tTitle " + std::to_string(i);
+            s.path = "/home/user/Music/" + s.artist + "/" + s.album + "/" + std::to_string(i % 12 + 1) + " - " + s.title + ".flac";
+            s.modified_time = 1700000000 + i;
+            s.duration = 180 + i % 240;
+            s.track_number = i % 12 + 1;
+        }
+        playlist.addSongs(songs);
+    }
+
+    fs::path dir = fs::temp_directory_path();
+    fs::path json_path = dir / ("smp_benchmark_" + std::to_string(::getpid()) + kJsonExtension);
+    fs::path binary_path = dir / ("smp_benchmark_" + std::to_string(::getpid()) + kBinaryExtension);
+    std::string dom_text = playlist.toJson().dump(4);
+    std::string stream_text;
+    writeJson(playlist, stream_text);
+    PersistenceWriter::writeAtomically(json_path, stream_text);
+    PersistenceWriter::writeAtomically(binary_path, encode(playlist));
+
+    // 正确性：流式输出与 DOM 输出相同，两种格式读回后内容不变
+    Playlist from_json;
+    Playlist from_binary;
+    json expected = playlist.toJson();
+    bool same_text = dom_text == stream_text;
+    bool json_lossless = load(json_path, from_json) && from_json.toJson() == expected;
+    bool binary_lossless = load(binary_path, from_binary) && from_binary.toJson() == expected;
+    dom_text.clear();
+    dom_text.shrink_to_fit();
+    stream_text.clear();
+    stream_text.shrink_to_fit();
+
+    const int iterations = 3;
+    size_t sink = 0;
+    struct Row {
+        const char* label;
+        Measurement m;
+    };
+    std::vector<Row> rows;
+    rows.push_back({"JSON 加载（DOM）", measureInChild([&]() {
+        std::ifstream i(json_path);
+        Playlist p = Playlist::fromJson(json::parse(i));
+        sink += p.size();
+    }, iterations)});
+    rows.push_back({"JSON 加载（SAX）", measureInChild([&]() {
+        Playlist p;
+        load(json_path, p);
+        sink += p.size();
+    }, iterations)});
+    rows.push_back({"二进制加载", measureInChild([&]() {
+        Playlist p;
+        load(binary_path, p);
+        sink += p.size();
+    }, iterations)});
+    rows.push_back({"仅映射遍历", measureInChild([&]() {
+        PlaylistView view;
+        if (!view.open(binary_path)) return;
+        for (size_t i = 0; i < view.size(); ++i) sink += view.song(i).path.size();
+    }, iterations)});
+    rows.push_back({"JSON 保存（DOM）", measureInChild([&]() {
+        sink += playlist.toJson().dump(4).size();
+    }, iterations)});
+    rows.push_back({"JSON 保存（流式）", measureInChild([&]() {
+        std::string text;
+        writeJson(playlist, text);
+        sink += text.size();
+    }, iterations)});
+    rows.push_back({"二进制保存", measureInChild([&]() {
+        sink += encode(playlist).size();
+    }, iterations)});
+
+    // 删除一首歌后落盘：整体重写二进制文件，或只追加一条日志记录（均含 fsync）
+    fs::path rewrite_path = dir / ("smp_benchmark_rewrite_" + std::to_string(::getpid()) + kBinaryExtension);
+    fs::path journal_path = dir / ("smp_benchmark_" + std::to_string(::getpid()) + PlaylistJournal::kExtension);
+    rows.push_back({"删除一首后重写文件", measureInChild([&]() {
+        playlist.removeSong(kSongs / 2);
+        PersistenceWriter::writeAtomically(rewrite_path, encode(playlist));
+    }, iterations)});
+    std::string record;
+    rows.push_back({"删除一首后追加日志", measureInChild([&]() {
+        playlist.removeSong(kSongs / 2);
+        record.clear();
+        PlaylistJournal::recordRemove(playlist, kSongs / 2, record);
+        PersistenceWriter::appendDurably(journal_path, record);
+    }, iterations)});
+    {
+        Playlist scratch; // 子进程中的修改不影响这里，记录长度与歌单内容无关
+        PlaylistJournal::recordRemove(scratch, kSongs / 2, record);
+    }
+
+    char line[200];
+    snprintf(line, sizeof(line), "歌单读写测试: %d 首, 每项 %d 次（各在独立子进程中运行）\n", kSongs, iterations);
+    out << line;
+    snprintf(line, sizeof(line), "  JSON 文件 %.2f MB, 二进制文件 %.2f MB\n",
+             fs::file_size(json_path) / (1024.0 * 1024.0), fs::file_size(binary_path) / (1024.0 * 1024.0));
+    out << line;
+    for (const auto& row : rows) {
+        std::string label = TextLayout::shared().pad(row.label, 18);
+        snprintf(line, sizeof(line), "  %s %8.2f ms  峰值内存 +%.1f MB\n", label.c_str(), row.m.ms, row.m.peakMb);
+        out << line;
+    }
+    snprintf(line, sizeof(line), "  删除一首：日志记录 %zu 字节，重写文件 %.2f MB\n",
+             record.size(), fs::file_size(binary_path) / (1024.0 * 1024.0));
+    out << line;
+    out << "  流式输出与 dump(4) " << (same_text ? "一致" : "不一致") << "\n";
+    out << "  JSON 往返转换" << (json_lossless ? "一致" : "不一致") << "，二进制往返转换"
+        << (binary_lossless ? "一致" : "不一致") << "\n";
+    (void)sink;
+
+    std::error_code ec;
+    fs::remove(json_path, ec);
+    fs::remove(binary_path, ec);
+    fs::remove(rewrite_path, ec);
+    fs::remove(journal_path, ec);
+}
@@ -0,0 +1,190 @@
+#include "PlaylistJournal.hpp"
+#include "PlaylistFile.hpp"
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+constexpr const char* PlaylistJournal::kExtension;
+constexpr uint64_t PlaylistJournal::kCompactBytes;
+
+namespace {
+enum class JournalOp : uint8_t { ADD = 1, REMOVE = 2, RENAME = 3, SORT = 4 };
+
+const size_t kRecordHeader = 4 + 8; // 长度 + 校验和
+
+template <typename T>
+void put(std::string& out, T value) {
+    out.append((const char*)&value, sizeof(value));
+}
+
+void putString(std::string& out, const std::string& text) {
+    put<uint32_t>(out, (uint32_t)text.size());
+    out += text;
+}
+
+// 开始一条记录：预留记录头并写入公共字段，返回记录起点
+size_t beginRecord(Playlist& playlist, JournalOp op, std::string& out) {
+    ++playlist.revision;
+    size_t start = out.size();
+    out.append(kRecordHeader, '\0');
+    put<uint64_t>(out, playlist.revision);
+    put<int64_t>(out, (int64_t)playlist.modified_time);
+    put<uint8_t>(out, (uint8_t)op);
+    return start;
+}
+
+// 填写记录头中的长度和校验和
+void finishRecord(std::string& out, size_t start) {
+    uint32_t length = (uint32_t)(out.size() - start - kRecordHeader);
+    uint64_t checksum = PlaylistFile::checksum(out.data() + start + kRecordHeader, length);
+    std::memcpy(&out[start], &length, sizeof(length));
+    std::memcpy(&out[start + 4], &checksum, sizeof(checksum));
+}
+
+// 按顺序读取记录内容，越界时 ok 变为 false
+class RecordReader {
+public:
+    RecordReader(const char* data, size_t size) : p(data), end(data + size) {}
+
+    template <typename T>
+    T get() {
+        T value{};
+        if ((size_t)(end - p) < sizeof(T)) {
+            ok = false;
+            return value;
+        }
+        std::memcpy(&value, p, sizeof(T));
+        p += sizeof(T);
+        return value;
+    }
+
+    std::string getString() {
+        uint32_t length = get<uint32_t>();
+        if (!ok || (size_t)(end - p) < length) {
+            ok = false;
+            return std::string();
+        }
+        std::string text(p, length);
+        p += length;
+        return text;
+    }
+
+    bool ok = true;
+
+private:
+    const char* p;
+    const char* end;
+};
+
+// 应用一条记录的操作数据，数据不完整时不修改歌单并返回 false
+bool apply(JournalOp op, RecordReader& in, Playlist& playlist) {
+    switch (op) {
+        case JournalOp::ADD: {
+            uint32_t count = in.get<uint32_t>();
+            std::vector<SongEntry> songs;
+            for (uint32_t i = 0; i < count && in.ok; ++i) {
+                SongEntry song;
+                song.path = in.getString();
+                song.title = in.getString();
+                song.artist = in.getString();
+                song.album = in.getString();
+                song.modified_time = (std::time_t)in.get<int64_t>();
+                song.duration = in.get<int32_t>();
+                song.track_number = in.get<int32_t>();
+                songs.push_back(std::move(song));
+            }
+            if (!in.ok) return false;
+            playlist.addSongs(songs);
+            return true;
+        }
+        case JournalOp::REMOVE: {
+            int32_t index = in.get<int32_t>();
+            if (!in.ok) return false;
+            playlist.removeSong(index);
+            return true;
+        }
+        case JournalOp::RENAME: {
+            std::string name = in.getString();
+            if (!in.ok) return false;
+            playlist.name = std::move(name);
+            return true;
+        }
+        case JournalOp::SORT: {
+            uint32_t count = in.get<uint32_t>();
+            if (!in.ok || count != playlist.size()) return false;
+            std::vector<uint32_t> order(count);
+            for (uint32_t i = 0; i < count && in.ok; ++i) order[i] = in.get<uint32_t>();
+            return in.ok && playlist.applyOrder(order);
+        }
+    }
+    return false;
+}
+}
+
+void PlaylistJournal::recordAdd(Playlist& playlist, const SongEntry* songs, size_t count, std::string& out) {
+    size_t start = beginRecord(playlist, JournalOp::ADD, out);
+    put<uint32_t>(out, (uint32_t)count);
+    for (size_t i = 0; i < count; ++i) {
+        const SongEntry& song = songs[i];
+        putString(out, song.path);
+        putString(out, song.title);
+        putString(out, song.artist);
+        putString(out, song.album);
+        put<int64_t>(out, (int64_t)song.modified_time);
+        put<int32_t>(out, song.duration);
+        put<int32_t>(out, song.track_number);
+    }
+    finishRecord(out, start);
+}
+
+void PlaylistJournal::recordRemove(Playlist& playlist, int index, std::string& out) {
+    size_t start = beginRecord(playlist, JournalOp::REMOVE, out);
+    put<int32_t>(out, index);
+    finishRecord(out, start);
+}
+
+void PlaylistJournal::recordRename(Playlist& playlist, std::string& out) {
+    size_t start = beginRecord(playlist, JournalOp::RENAME, out);
+    putString(out, playlist.name);
+    finishRecord(out, start);
+}
+
+void PlaylistJournal::recordSort(Playlist& playlist, const std::vector<uint32_t>& order, std::string& out) {
+    size_t start = beginRecord(playlist, JournalOp::SORT, out);
+    put<uint32_t>(out, (uint32_t)order.size());
+    out.append((const char*)order.data(), order.size() * sizeof(uint32_t));
+    finishRecord(out, start);
+}
+
+bool PlaylistJournal::replay(const fs::path& path, Playlist& playlist, uint64_t& valid_bytes) {
+    valid_bytes = 0;
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) return true;
+    std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    size_t pos = 0;
+    while (data.size() - pos >= kRecordHeader) {
+        uint32_t length;
+        uint64_t checksum;
+        std::memcpy(&length, data.data() + pos, sizeof(length));
+        std::memcpy(&checksum, data.data() + pos + 4, sizeof(checksum));
+        const char* payload = data.data() + pos + kRecordHeader;
+        // 写到一半的记录（长度越界）或内容损坏
+        if (length > data.size() - pos - kRecordHeader || PlaylistFile::checksum(payload, length) != checksum) break;
+
+        RecordReader reader(payload, length);
+        uint64_t revision = reader.get<uint64_t>();
+        std::time_t modified_time = (std::time_t)reader.get<int64_t>();
+        JournalOp op = (JournalOp)reader.get<uint8_t>();
+        if (!reader.ok) break;
+        if (revision > playlist.revision) {
+            // 已包含在歌单文件中的记录直接跳过；序号不连续说明中间的记录丢失
+            if (revision != playlist.revision + 1 || !apply(op, reader, playlist)) break;
+            playlist.revision = revision;
+            playlist.modified_time = modified_time;
+        }
+        pos += kRecordHeader + length;
+    }
+    valid_bytes = pos;
+    return pos == data.size();
+}
@@ -0,0 +1,126 @@
+#include "SpectrumAnalyzer.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+const double kPi = 3.14159265358979323846;
+const double kMinFrequency = 40.0;     // 最低频段起点（Hz）
+const double kMaxFrequency = 16000.0;  // 最高频段终点（Hz）
+const double kFallPerSecond = 1.5;     // 频段高度每秒回落量（满刻度为 1）
+const double kHoldFallPerSecond = 0.5; // 峰值保持每秒回落量（线性）
+}
+
+SpectrumAnalyzer::SpectrumAnalyzer()
+    : window(kFftSize), twiddles(kFftSize / 2), bitReverse(kFftSize),
+      spectrum(kFftSize), frames(kFftSize * AudioTap::kChannels) {
+    for (size_t i = 0; i < kFftSize; ++i) {
+        window[i] = (float)(0.5 - 0.5 * std::cos(2.0 * kPi * i / (kFftSize - 1)));
+    }
+    for (size_t i = 0; i < kFftSize / 2; ++i) {
+        double angle = -2.0 * kPi * i / kFftSize;
+        twiddles[i] = std::complex<float>((float)std::cos(angle), (float)std::sin(angle));
+    }
+    size_t bits = 0;
+    while (((size_t)1 << bits) < kFftSize) ++bits;
+    for (size_t i = 0; i < kFftSize; ++i) {
+        size_t r = 0;
+        for (size_t b = 0; b < bits; ++b) {
+            if (i & ((size_t)1 << b)) r |= (size_t)1 << (bits - 1 - b);
+        }
+        bitReverse[i] = r;
+    }
+}
+
+void SpectrumAnalyzer::fft() {
+    // 原地迭代基 2 FFT
+    for (size_t i = 0; i < kFftSize; ++i) {
+        if (i < bitReverse[i]) std::swap(spectrum[i], spectrum[bitReverse[i]]);
+    }
+    for (size_t len = 2; len <= kFftSize; len <<= 1) {
+        size_t half = len / 2;
+        size_t step = kFftSize / len;
+        for (size_t start = 0; start < kFftSize; start += len) {
+            for (size_t k = 0; k < half; ++k) {
+                std::complex<float> t = twiddles[k * step] * spectrum[start + k + half];
+                spectrum[start + k + half] = spectrum[start + k] - t;
+                spectrum[start + k] += t;
+            }
+        }
+    }
+}
+
+void SpectrumAnalyzer::decay(double elapsed_ms) {
+    float fall = (float)(kFallPerSecond * elapsed_ms / 1000.0);
+    for (auto& level : bandLevels) level = std::max(0.0f, level - fall);
+    float hold_fall = (float)(kHoldFallPerSecond * elapsed_ms / 1000.0);
+    for (auto& meter : meters) {
+        meter.peak = 0.0f;
+        meter.rms = 0.0f;
+        meter.peakHold = std::max(0.0f, meter.peakHold - hold_fall);
+    }
+}
+
+void SpectrumAnalyzer::update(const AudioTap& tap, int sample_rate, int bands, double elapsed_ms) {
+    if (bands < 1) bands = 1;
+    if ((int)bandLevels.size() != bands) bandLevels.assign(bands, 0.0f);
+
+    // 没有新数据（暂停或停止）时逐渐回落
+    uint64_t position = tap.position();
+    if (position == lastPosition || sample_rate <= 0) {
+        decay(elapsed_ms);
+        return;
+    }
+    lastPosition = position;
+    size_t got = tap.readLatest(frames.data(), kFftSize);
+
+    // 电平：取最近一个界面刷新周期内的样本
+    size_t meter_frames = std::min(got, std::max<size_t>(1, (size_t)(sample_rate * elapsed_ms / 1000.0)));
+    float hold_fall = (float)(kHoldFallPerSecond * elapsed_ms / 1000.0);
+    for (int c = 0; c < AudioTap::kChannels; ++c) {
+        float peak = 0.0f;
+        double sum = 0.0;
+        for (size_t i = got - meter_frames; i < got; ++i) {
+            float v = frames[i * AudioTap::kChannels + c];
+            peak = std::max(peak, std::fabs(v));
+            sum += (double)v * v;
+        }
+        LevelMeter& meter = meters[c];
+        meter.peak = peak;
+        meter.rms = meter_frames > 0 ? (float)std::sqrt(sum / meter_frames) : 0.0f;
+        meter.peakHold = std::max(peak, meter.peakHold - hold_fall);
+    }
+
+    // 频谱：左右声道混合后加窗（不足一个窗口时补零）
+    size_t offset = kFftSize - got;
+    for (size_t i = 0; i < kFftSize; ++i) {
+        float v = 0.0f;
+        if (i >= offset) {
+            const float* frame = &frames[(i - offset) * AudioTap::kChannels];
+            v = 0.5f * (frame[0] + frame[1]);
+        }
+        spectrum[i] = std::complex<float>(v * window[i], 0.0f);
+    }
+    fft();
+
+    // 按对数间隔分组，每组取最大幅度
+    double nyquist = sample_rate / 2.0;
+    double high = std::min(kMaxFrequency, nyquist);
+    double ratio = std::pow(high / kMinFrequency, 1.0 / bands);
+    double bin_width = (double)sample_rate / kFftSize;
+    float scale = 4.0f / kFftSize; // Hann 窗增益 0.5，单边谱再乘 2
+    float fall = (float)(kFallPerSecond * elapsed_ms / 1000.0);
+    for (int b = 0; b < bands; ++b) {
+        double lo = kMinFrequency * std::pow(ratio, b);
+        double hi = lo * ratio;
+        size_t first = std::max<size_t>(1, (size_t)(lo / bin_width));
+        size_t last = std::min(kFftSize / 2, std::max(first + 1, (size_t)std::ceil(hi / bin_width)));
+        float magnitude = 0.0f;
+        for (size_t k = first; k < last; ++k) {
+            magnitude = std::max(magnitude, std::abs(spectrum[k]) * scale);
+        }
+        double db = 20.0 * std::log10(std::max(magnitude, 1e-9f));
+        float level = (float)std::max(0.0, std::min(1.0, (db - kFloorDb) / -kFloorDb));
+        // 上升立即跟随，下降按固定速度回落
+        bandLevels[b] = std::max(level, bandLevels[b] - fall);
+    }
+}
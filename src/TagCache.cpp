@@ -0,0 +1,93 @@
+#include "TagCache.hpp"
+#include "PersistenceWriter.hpp"
+#include <fstream>
+#include <cstdlib>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+TagCache& TagCache::instance() {
+    static TagCache cache;
+    return cache;
+}
+
+fs::path TagCache::getCacheFilePath() {
+    const char* home_env = std::getenv("HOME");
+    fs::path p = home_env ? fs::path(home_env) / ".config" / "simple_music_player" : fs::current_path();
+    if (!fs::exists(p)) fs::create_directories(p);
+    return p / "tag_cache.json";
+}
+
+void TagCache::loadIfNeeded() {
+    // 调用者需持有 mutex
+    if (loaded) return;
+    loaded = true;
+
+    fs::path p = getCacheFilePath();
+    if (!fs::exists(p)) return;
+    std::ifstream i(p);
+    try {
+        json j = json::parse(i);
+        if (!j.contains("entries") || !j["entries"].is_array()) return;
+        entries.reserve(j["entries"].size());
+        for (const auto& e : j["entries"]) {
+            CachedTags tags;
+            tags.size = e.value("size", (std::uintmax_t)0);
+            tags.mtime = e.value("mtime", (std::int64_t)0);
+            tags.title = e.value("title", "");
+            tags.artist = e.value("artist", "");
+            tags.album = e.value("album", "");
+            tags.duration = e.value("duration", 0);
+            tags.track_number = e.value("track_number", 0);
+            entries[e.value("path", "")] = std::move(tags);
+        }
+    } catch (...) {
+        // 缓存损坏时直接丢弃，下次保存时重建
+        entries.clear();
+    }
+}
+
+bool TagCache::lookup(const std::string& path, std::uintmax_t size, std::int64_t mtime, CachedTags& out) {
+    std::lock_guard<std::mutex> lock(mutex);
+    loadIfNeeded();
+    auto it = entries.find(path);
+    if (it == entries.end() || it->second.size != size || it->second.mtime != mtime) {
+        return false;
+    }
+    out = it->second;
+    return true;
+}
+
+void TagCache::store(const std::string& path, const CachedTags& tags) {
+    std::lock_guard<std::mutex> lock(mutex);
+    loadIfNeeded();
+    entries[path] = tags;
+    dirty = true;
+}
+
+void TagCache::save() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!dirty) return;
+
+    json entries_json = json::array();
+    for (const auto& [path, tags] : entries) {
+        json e;
+        e["path"] = path;
+        e["size"] = tags.size;
+        e["mtime"] = tags.mtime;
+        e["title"] = tags.title;
+        e["artist"] = tags.artist;
+        e["album"] = tags.album;
+        e["duration"] = tags.duration;
+        e["track_number"] = tags.track_number;
+        entries_json.push_back(std::move(e));
+    }
+    json j;
+    j["version"] = 1;
+    j["entries"] = std::move(entries_json);
+
+    // 缓存文件较大，不做缩进；原子替换，避免写到一半退出导致缓存损坏
+    if (PersistenceWriter::writeAtomically(getCacheFilePath(), j.dump())) {
+        dirty = false;
+    }
+}
@@ -0,0 +1,170 @@
+#include "TextLayout.hpp"
+#include <algorithm>
+#include <cwchar>
+
+namespace {
+const char* const kEllipsis = "...";
+const int kEllipsisWidth = 3;
+
+// 当前区域设置不是 UTF-8 时 wcwidth 无法识别宽字符，按东亚宽字符范围兜底
+bool isWide(char32_t cp) {
+    return (cp >= 0x1100 && cp <= 0x115F) || (cp >= 0x2E80 && cp <= 0xA4CF) ||
+           (cp >= 0xAC00 && cp <= 0xD7A3) || (cp >= 0xF900 && cp <= 0xFAFF) ||
+           (cp >= 0xFE30 && cp <= 0xFE4F) || (cp >= 0xFF00 && cp <= 0xFF60) ||
+           (cp >= 0xFFE0 && cp <= 0xFFE6) || (cp >= 0x1F300 && cp <= 0x1F64F) ||
+           (cp >= 0x1F900 && cp <= 0x1F9FF) || (cp >= 0x20000 && cp <= 0x3FFFD);
+}
+}
+
+TextLayout& TextLayout::shared() {
+    static TextLayout instance;
+    return instance;
+}
+
+size_t TextLayout::decode(std::string_view text, size_t pos, char32_t& cp) {
+    unsigned char c = (unsigned char)text[pos];
+    size_t length;
+    if (c < 0x80) {
+        cp = c;
+        return 1;
+    } else if ((c & 0xE0) == 0xC0) {
+        cp = c & 0x1F;
+        length = 2;
+    } else if ((c & 0xF0) == 0xE0) {
+        cp = c & 0x0F;
+        length = 3;
+    } else if ((c & 0xF8) == 0xF0) {
+        cp = c & 0x07;
+        length = 4;
+    } else {
+        cp = 0xFFFD;
+        return 1;
+    }
+    if (pos + length > text.size()) {
+        cp = 0xFFFD;
+        return 1;
+    }
+    for (size_t i = 1; i < length; ++i) {
+        unsigned char next = (unsigned char)text[pos + i];
+        if ((next & 0xC0) != 0x80) {
+            cp = 0xFFFD;
+            return 1;
+        }
+        cp = (cp << 6) | (next & 0x3F);
+    }
+    return length;
+}
+
+int TextLayout::charWidth(char32_t cp) {
+    if (cp < 0x20 || (cp >= 0x7F && cp < 0xA0)) return 0;
+    if (cp < 0x7F) return 1;
+    int w = ::wcwidth((wchar_t)cp);
+    if (w >= 0) {
+        // 非 UTF-8 区域设置下 wcwidth 可能把宽字符报告为 1 列
+        return (w == 1 && isWide(cp)) ? 2 : w;
+    }
+    return isWide(cp) ? 2 : 1;
+}
+
+void TextLayout::measure(std::string_view text, TextMetrics& out) {
+    out.width = 0;
+    out.ends.clear();
+    out.columns.clear();
+    out.ends.reserve(text.size());
+    out.columns.reserve(text.size());
+    size_t pos = 0;
+    while (pos < text.size()) {
+        char32_t cp;
+        pos += decode(text, pos, cp);
+        out.width += charWidth(cp);
+        out.ends.push_back((uint32_t)pos);
+        out.columns.push_back((uint32_t)out.width);
+    }
+}
+
+int TextLayout::displayWidth(std::string_view text) {
+    int width = 0;
+    size_t pos = 0;
+    while (pos < text.size()) {
+        char32_t cp;
+        pos += decode(text, pos, cp);
+        width += charWidth(cp);
+    }
+    return width;
+}
+
+const TextMetrics& TextLayout::metrics(const std::string& text) {
+    auto it = cache.find(text);
+    if (it != cache.end()) return it->second;
+    if (cache.size() >= kMaxEntries) cache.clear();
+    TextMetrics& entry = cache[text];
+    measure(text, entry);
+    return entry;
+}
+
+std::string TextLayout::truncate(const std::string& text, int width) {
+    const TextMetrics& m = metrics(text);
+    if (m.width <= width) return text;
+    if (width <= kEllipsisWidth) return std::string(kEllipsis, std::max(0, width));
+    // 最后一个累计宽度不超过 width - 3 的字符
+    auto it = std::upper_bound(m.columns.begin(), m.columns.end(), (uint32_t)(width - kEllipsisWidth));
+    size_t chars = it - m.columns.begin();
+    size_t bytes = chars > 0 ? m.ends[chars - 1] : 0;
+    return text.substr(0, bytes) + kEllipsis;
+}
+
+std::string TextLayout::pad(const std::string& text, int width) {
+    int w = metrics(text).width;
+    if (w >= width) return text;
+    return text + std::string(width - w, ' ');
+}
+
+void TextLayout::wrap(std::string_view text, int width, std::vector<std::string>& out) {
+    if (text.empty()) {
+        out.emplace_back();
+        return;
+    }
+    width = std::max(1, width);
+
+    // 先解码一次，记录每个字符的位置、宽度，以及其后能否断开（空格和中日韩字符之后可以）
+    struct Glyph {
+        uint32_t begin;
+        uint32_t end;
+        int width;
+        bool breakAfter;
+        bool space;
+    };
+    std::vector<Glyph> glyphs;
+    glyphs.reserve(text.size());
+    size_t pos = 0;
+    while (pos < text.size()) {
+        char32_t cp;
+        size_t length = decode(text, pos, cp);
+        int w = charWidth(cp);
+        glyphs.push_back({(uint32_t)pos, (uint32_t)(pos + length), w, cp == ' ' || w == 2, cp == ' '});
+        pos += length;
+    }
+
+    size_t count = glyphs.size();
+    size_t start = 0;
+    while (start < count) {
+        int columns = 0;
+        size_t last_break = 0; // 断开后下一行的起始字符，0 表示本行没有断点
+        size_t i = start;
+        while (i < count && (columns + glyphs[i].width <= width || i == start)) {
+            columns += glyphs[i].width;
+            if (glyphs[i].breakAfter) last_break = i + 1;
+            ++i;
+        }
+        // 溢出的字符本身是空格或宽字符时可以直接在它之前断开
+        size_t cut = i;
+        if (i < count && !glyphs[i].space && glyphs[i].width != 2 && last_break > start) cut = last_break;
+        // 去掉行尾空格
+        size_t last = cut;
+        while (last > start && glyphs[last - 1].space) --last;
+        out.emplace_back(text.substr(glyphs[start].begin, last > start ? glyphs[last - 1].end - glyphs[start].begin : 0));
+        // 下一行开头的空格不显示
+        start = cut;
+        while (start < count && glyphs[start].space) ++start;
+    }
+}
@@ -1,4 +1,5 @@
 #include "UIHelpers.hpp"
+#include "TextLayout.hpp"
 #include <ncurses.h>
 #include <clocale>
 #include <algorithm>
@@ -119,6 +120,38 @@ const HelpInfo SETTINGS_HELP = {
     }
 };
 
+const HelpInfo CROSSFADE_HELP = {
+    "淡入淡出帮助",
+    {
+        {"↑ ↓", "上下移动"},
+        {"PgUp/PgDn", "翻页"},
+        {"Enter", "选择时长"},
+        {"H", "帮助"},
+        {"Q", "返回设置"}
+    }
+};
+
+const HelpInfo REPLAY_GAIN_HELP = {
+    "音量均衡帮助",
+    {
+        {"↑ ↓", "上下移动"},
+        {"Enter", "选择模式"},
+        {"H", "帮助"},
+        {"Q", "返回设置"}
+    }
+};
+
+const HelpInfo EQUALIZER_HELP = {
+    "均衡器帮助",
+    {
+        {"↑ ↓", "上下移动"},
+        {"PgUp/PgDn", "翻页"},
+        {"Enter", "开关均衡器 / 选择预设"},
+        {"H", "帮助"},
+        {"Q", "返回设置"}
+    }
+};
+
 const HelpInfo PLAY_MODE_HELP = {
     "播放模式帮助",
     {
@@ -131,18 +164,27 @@ const HelpInfo PLAY_MODE_HELP = {
 
 void drawPageMenu(const std::string& title, const std::vector<std::string>& options, 
                   PageMenu& page_menu, bool show_numbers) {
+    drawPageMenu(title, (int)options.size(),
+                 [&options](int i) -> std::string { return options[i]; },
+                 page_menu, show_numbers);
+}
+
+void drawPageMenu(const std::string& title, int total_items, const RowProvider& row_provider,
+                  PageMenu& page_menu, bool show_numbers) {
     // 动态计算每页显示的项目数，基于终端高度
     int available_height = LINES - 10; // 减去标题、页码信息、底部提示等空间
     int dynamic_items_per_page = std::max(5, available_height); // 至少显示5项
     
     // 启用动态分页
     page_menu.setDynamicPaging(true, dynamic_items_per_page);
-    page_menu.update(options.size());
+    page_menu.update(total_items);
     
     int start_y = 1;
-    mvprintw(start_y, 2, "--- %s ---", title.c_str());
+    // 标题中含歌单名、歌曲名等，同样按显示宽度截断
+    std::string shown_title = TextLayout::shared().truncate(title, COLS - 10);
+    mvprintw(start_y, 2, "--- %s ---", shown_title.c_str());
     
-    if (options.empty()) {
+    if (total_items <= 0) {
         mvprintw(start_y + 2, 4, "[列表为空]");
     } else {
         int page_start = page_menu.getPageStart();
@@ -154,20 +196,18 @@ void drawPageMenu(const std::string& title, const std::vector<std::string>& opti
                 attron(A_REVERSE);
             }
             
+            // 只为当前页可见的行生成文本
             std::string display_text;
             if (show_numbers) {
-                char buffer[64];
-                snprintf(buffer, sizeof(buffer), "%3d. %s", i + 1, options[i].c_str());
-                display_text = buffer;
+                char number[16];
+                snprintf(number, sizeof(number), "%3d. ", i + 1);
+                display_text = number + row_provider(i);
             } else {
-                display_text = options[i];
+                display_text = row_provider(i);
             }
             
-            // 截断以适应屏幕宽度
-            int max_width = COLS - 10;
-            if ((int)display_text.length() > max_width) {
-                display_text = display_text.substr(0, max_width - 3) + "...";
-            }
+            // 按显示宽度截断以适应屏幕宽度（不拆开多字节字符）
+            display_text = TextLayout::shared().truncate(display_text, COLS - 10);
             
             mvprintw(start_y + 2 + display_idx, 4, "%s %s", 
                     (i == page_menu.selected_index ? ">" : " "), display_text.c_str());
@@ -198,10 +238,11 @@ void drawHelp(const HelpInfo& help) {
     int start_y = 1;
     mvprintw(start_y, 2, "--- %s ---", help.title.c_str());
     
-    // 计算最大按键名称长度
+    // 计算最大按键名称的显示宽度（"↑ ↓" 等字符的字节数与列数不同）
+    TextLayout& layout = TextLayout::shared();
     int max_key_len = 0;
     for (const auto& cmd : help.commands) {
-        int len = cmd.first.length();
+        int len = layout.width(cmd.first);
         if (len > max_key_len) {
             max_key_len = len;
         }
@@ -213,7 +254,7 @@ void drawHelp(const HelpInfo& help) {
     int y = start_y + 2;
     for (const auto& cmd : help.commands) {
         // 使用动态计算的宽度进行对齐
-        mvprintw(y, 4, "%-*s : %s", max_key_len, cmd.first.c_str(), cmd.second.c_str());
+        mvprintw(y, 4, "%s : %s", layout.pad(cmd.first, max_key_len).c_str(), cmd.second.c_str());
         y++;
     }
     
@@ -229,7 +270,7 @@ std::string inputField(const std::string& prompt) {
     erase(); // 清屏，避免菜单干扰输入框显示
     mvprintw(LINES / 2, 4, "%s", prompt.c_str());
     refresh();
-    getstr(buf);
+    getnstr(buf, sizeof(buf) - 1);
     noecho();
     curs_set(0);
     nodelay(stdscr, TRUE);
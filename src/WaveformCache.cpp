@@ -0,0 +1,234 @@
+#include "WaveformCache.hpp"
+#include "AudioDecoder.hpp"
+#include "PersistenceWriter.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+namespace {
+const char kMagic[4] = {'S', 'M', 'P', 'W'};
+const uint32_t kVersion = 1;
+const int kReadFrames = 16384;
+// 限速：每解码一块后休眠同样长的时间，最多占用半个核心
+const double kDutyCycle = 0.5;
+
+std::int64_t fileMtime(const fs::path& p, std::error_code& ec) {
+    return (std::int64_t)fs::last_write_time(p, ec).time_since_epoch().count();
+}
+
+// FNV-1a：缓存文件名需要跨版本稳定，不使用 std::hash
+uint64_t hashPath(const std::string& path) {
+    uint64_t h = 1469598103934665603ull;
+    for (unsigned char c : path) {
+        h ^= c;
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+struct FileHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t size;
+    int64_t mtime;
+    uint32_t buckets;
+    uint32_t pathLength;
+};
+}
+
+float WaveformSummary::amplitude(double begin, double end) const {
+    if (mins.empty()) return 0.0f;
+    int count = (int)mins.size();
+    int first = std::max(0, std::min(count - 1, (int)(begin * count)));
+    int last = std::max(first + 1, std::min(count, (int)std::ceil(end * count)));
+    int peak = 0;
+    for (int i = first; i < last; ++i) {
+        peak = std::max(peak, std::max(-(int)mins[i], (int)maxs[i]));
+    }
+    return peak / 127.0f;
+}
+
+WaveformCache::WaveformCache() {
+    thread = std::thread(&WaveformCache::worker, this);
+}
+
+WaveformCache::~WaveformCache() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    cv.notify_all();
+    if (thread.joinable()) thread.join();
+}
+
+void WaveformCache::request(const std::string& path) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (path == requested) return;
+        requested = path;
+        summary.reset();
+        // 改变代号即可让正在进行的计算在下一块时放弃
+        requestGeneration.fetch_add(1, std::memory_order_relaxed);
+    }
+    cv.notify_all();
+}
+
+std::shared_ptr<const WaveformSummary> WaveformCache::current() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return summary;
+}
+
+void WaveformCache::worker() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        cv.wait(lock, [this]() {
+            return stopping || doneGeneration != requestGeneration.load(std::memory_order_relaxed);
+        });
+        if (stopping) return;
+
+        uint64_t generation = requestGeneration.load(std::memory_order_relaxed);
+        std::string path = requested;
+        doneGeneration = generation;
+        if (path.empty()) continue;
+        lock.unlock();
+
+        auto result = std::make_shared<WaveformSummary>();
+        bool ok = compute(path, generation, *result);
+
+        lock.lock();
+        if (ok && requestGeneration.load(std::memory_order_relaxed) == generation) {
+            summary = result;
+        }
+    }
+}
+
+bool WaveformCache::compute(const std::string& path, uint64_t generation, WaveformSummary& out) {
+    std::error_code ec;
+    std::uintmax_t size = fs::file_size(path, ec);
+    if (ec) return false;
+    std::int64_t mtime = fileMtime(path, ec);
+    if (ec) return false;
+
+    fs::path file = getCacheFile(path);
+    if (loadFile(file, path, size, mtime, out)) return true;
+
+    AudioDecoder decoder;
+    if (!decoder.open(path, 0, 0)) return false;
+    int channels = decoder.sourceChannels();
+    long long total = (long long)(decoder.duration() * decoder.sourceRate());
+    if (channels <= 0 || total <= 0) return false;
+
+    const int buckets = WaveformSummary::kBuckets;
+    std::vector<float> lo(buckets, 0.0f), hi(buckets, 0.0f);
+    std::vector<float> buffer((size_t)kReadFrames * channels);
+    long long position = 0;
+    int got;
+    while ((got = decoder.read(buffer.data(), kReadFrames)) > 0) {
+        if (cancelled(generation)) return false;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < got; ++i) {
+            int b = (int)std::min<long long>(buckets - 1, (position + i) * buckets / total);
+            const float* frame = &buffer[(size_t)i * channels];
+            for (int c = 0; c < channels; ++c) {
+                lo[b] = std::min(lo[b], frame[c]);
+                hi[b] = std::max(hi[b], frame[c]);
+            }
+        }
+        position += got;
+        auto spent = std::chrono::steady_clock::now() - start;
+        std::this_thread::sleep_for(spent * ((1.0 - kDutyCycle) / kDutyCycle));
+    }
+    if (cancelled(generation)) return false;
+
+    out.path = path;
+    out.mins.resize(buckets);
+    out.maxs.resize(buckets);
+    for (int b = 0; b < buckets; ++b) {
+        out.mins[b] = (int8_t)std::lround(std::max(-1.0f, lo[b]) * 127.0f);
+        out.maxs[b] = (int8_t)std::lround(std::min(1.0f, hi[b]) * 127.0f);
+    }
+    saveFile(file, out, size, mtime);
+    return true;
+}
+
+bool WaveformCache::loadFile(const fs::path& file, const std::string& path, std::uintmax_t size,
+                             std::int64_t mtime, WaveformSummary& out) const {
+    std::ifstream in(file, std::ios::binary);
+    if (!in.is_open()) return false;
+    FileHeader header{};
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header))) return false;
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion ||
+        header.size != size || header.mtime != mtime || header.buckets == 0 ||
+        header.buckets > 65536 || header.pathLength != path.size()) {
+        return false;
+    }
+    // 文件名是路径的哈希，需核对路径以排除冲突
+    std::string stored(header.pathLength, '\0');
+    if (!in.read(&stored[0], header.pathLength) || stored != path) return false;
+    out.mins.resize(header.buckets);
+    out.maxs.resize(header.buckets);
+    if (!in.read(reinterpret_cast<char*>(out.mins.data()), header.buckets)) return false;
+    if (!in.read(reinterpret_cast<char*>(out.maxs.data()), header.buckets)) return false;
+    out.path = path;
+    // 命中时更新修改时间，清理时按最近使用的先后保留
+    std::error_code ec;
+    fs::last_write_time(file, fs::file_time_type::clock::now(), ec);
+    return true;
+}
+
+void WaveformCache::saveFile(const fs::path& file, const WaveformSummary& summary, std::uintmax_t size,
+                             std::int64_t mtime) const {
+    FileHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.size = size;
+    header.mtime = mtime;
+    header.buckets = (uint32_t)summary.mins.size();
+    header.pathLength = (uint32_t)summary.path.size();
+
+    // 先在内存中序列化再原子替换，中途崩溃不会留下截断的缓存文件
+    std::string data;
+    data.reserve(sizeof(header) + summary.path.size() + summary.mins.size() * 2);
+    data.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    data.append(summary.path);
+    data.append(reinterpret_cast<const char*>(summary.mins.data()), summary.mins.size());
+    data.append(reinterpret_cast<const char*>(summary.maxs.data()), summary.maxs.size());
+    if (!PersistenceWriter::writeAtomically(file, data)) return;
+    prune(file.parent_path());
+}
+
+void WaveformCache::prune(const fs::path& dir) {
+    std::vector<std::pair<fs::file_time_type, fs::path>> files;
+    std::error_code ec;
+    for (fs::directory_iterator it(dir, ec), end; !ec && it != end; it.increment(ec)) {
+        if (it->path().extension() != ".wf") continue;
+        std::error_code entry_ec;
+        auto time = it->last_write_time(entry_ec);
+        if (!entry_ec) files.emplace_back(time, it->path());
+    }
+    if (files.size() <= kMaxFiles) return;
+    size_t excess = files.size() - kMaxFiles;
+    std::nth_element(files.begin(), files.begin() + excess, files.end());
+    for (size_t i = 0; i < excess; ++i) {
+        fs::remove(files[i].second, ec);
+    }
+}
+
+fs::path WaveformCache::getCacheDir() {
+    const char* home_env = std::getenv("HOME");
+    fs::path p = home_env ? fs::path(home_env) / ".config" / "simple_music_player" : fs::current_path();
+    p /= "waveforms";
+    std::error_code ec;
+    if (!fs::exists(p, ec)) fs::create_directories(p, ec);
+    return p;
+}
+
+fs::path WaveformCache::getCacheFile(const std::string& path) {
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.wf", (unsigned long long)hashPath(path));
+    return getCacheDir() / name;
+}
@@ -5,51 +5,23 @@
 #include <vector>
 #include <filesystem>
 #include <algorithm>
+#include <iostream>
+#include <cmath>
+#include <memory>
 #include "AppController.hpp"
+#include "GainStage.hpp"
+#include "LyricLayout.hpp"
+#include "LyricParser.hpp"
+#include "PlaylistFile.hpp"
+#include "SpectrumAnalyzer.hpp"
+#include "TextLayout.hpp"
 #include "UIHelpers.hpp"
 
 namespace fs = std::filesystem;
 
-// 辅助函数：将长歌词分割为多行
-std::vector<std::string> splitLyricLines(const std::string& lyric, int max_width) {
-    std::vector<std::string> lines;
-    if (lyric.empty()) return lines;
-    
-    std::string remaining = lyric;
-    while (!remaining.empty()) {
-        if ((int)remaining.length() <= max_width) {
-            lines.push_back(remaining);
-            break;
-        }
-        
-        // 尝试在空格处分割
-        int split_pos = max_width;
-        for (int i = max_width; i >= 0; --i) {
-            if (i < (int)remaining.length() && remaining[i] == ' ') {
-                split_pos = i;
-                break;
-            }
-        }
-        
-        // 如果没有找到空格，就在max_width处强制分割
-        if (split_pos == max_width) {
-            split_pos = max_width;
-        }
-        
-        lines.push_back(remaining.substr(0, split_pos));
-        remaining = remaining.substr(split_pos);
-        
-        // 移除开头的空格
-        while (!remaining.empty() && remaining[0] == ' ') {
-            remaining = remaining.substr(1);
-        }
-    }
-    
-    return lines;
-}
-
 // --- 全局变量 ---
-AppController ctrl;
+// 控制器在 main 处理完命令行模式后才构造：构造时会打开音频设备、恢复播放并启动后台线程
+std::unique_ptr<AppController> ctrl;
 PageMenu main_menu_page;
 PageMenu playlist_manager_page;
 PageMenu playlist_menu_page;    // 歌单功能菜单
@@ -65,18 +37,89 @@ int current_playlist_song_index = -1;      // 当前播放列表中选中的歌
 std::string song_to_add_path = "";         // 要添加的歌曲路径（如果为空，则添加当前播放的歌曲）
 SortBy selected_sort_by = SortBy::TITLE;   // 选择的排序方式
 PageMenu sort_order_page;                 // 排序顺序菜单页面
+SpectrumAnalyzer spectrum_analyzer;       // 播放界面的频谱/电平显示
+LyricLayout lyric_layout;                 // 当前歌曲歌词的折行缓存
+auto last_visualizer_update = std::chrono::steady_clock::now();
 
 // --- 辅助函数 ---
 void enterHelp() {
-    previous_state = ctrl.state;
-    ctrl.state = AppState::HELP;
+    previous_state = ctrl->state;
+    ctrl->state = AppState::HELP;
+}
+
+std::string replayGainModeName(ReplayGainMode mode) {
+    switch (mode) {
+        case ReplayGainMode::OFF: return "关闭";
+        case ReplayGainMode::TRACK: return "单曲增益";
+        case ReplayGainMode::ALBUM: return "专辑增益";
+    }
+    return "";
+}
+
+// 竖向/横向的 1/8 格块字符
+const char* const kVerticalBlocks[] = {" ", "▁", "▂", "▃", "▄", "▅", "▆", "▇", "█"};
+const char* const kHorizontalBlocks[] = {"", "▏", "▎", "▍", "▌", "▋", "▊", "▉", "█"};
+
+// 线性幅度转换为 0-1 的显示比例（-60 dB 到 0 dB）
+double meterScale(float amplitude) {
+    double db = 20.0 * std::log10(std::max(amplitude, 1e-9f));
+    return std::max(0.0, std::min(1.0, (db + 60.0) / 60.0));
+}
+
+// 在 top 行开始绘制频谱（height 行）和左右声道电平表（2 行）
+void renderVisualizer(int top, int height) {
+    auto& player = ctrl->getPlayer();
+    auto now = std::chrono::steady_clock::now();
+    double elapsed_ms = std::chrono::duration<double, std::milli>(now - last_visualizer_update).count();
+    last_visualizer_update = now;
+    
+    int bands = std::max(1, std::min(64, (COLS - 6) / 2));
+    spectrum_analyzer.update(player.getAudioTap(), player.getOutputRate(), bands, std::min(elapsed_ms, 200.0));
+    
+    // 频谱：每个频段一列，列间留一个空格，每格 8 级高度
+    const auto& levels = spectrum_analyzer.getBands();
+    for (int row = 0; row < height; ++row) {
+        std::string line;
+        for (float level : levels) {
+            int eighths = (int)(level * height * 8 + 0.5f) - (height - 1 - row) * 8;
+            line += kVerticalBlocks[std::max(0, std::min(8, eighths))];
+            line += ' ';
+        }
+        attron(COLOR_PAIR(1));
+        mvprintw(top + row, 4, "%s", line.c_str());
+        attroff(COLOR_PAIR(1));
+    }
+    
+    // 电平表：长条为 RMS，竖线为峰值保持
+    int width = std::max(10, COLS - 36);
+    const char* names[] = {"L", "R"};
+    for (int c = 0; c < AudioTap::kChannels; ++c) {
+        const LevelMeter& meter = spectrum_analyzer.getMeter(c);
+        int rms_eighths = (int)(meterScale(meter.rms) * width * 8);
+        int hold_cell = meter.peakHold > 0.0f ? std::min(width - 1, (int)(meterScale(meter.peakHold) * width)) : -1;
+        std::string bar;
+        for (int i = 0; i < width; ++i) {
+            int eighths = std::max(0, std::min(8, rms_eighths - i * 8));
+            if (i == hold_cell && eighths < 8) {
+                bar += "│";
+            } else if (eighths > 0) {
+                bar += kHorizontalBlocks[eighths];
+            } else {
+                bar += ' ';
+            }
+        }
+        double peak_db = 20.0 * std::log10(std::max(meter.peak, 1e-9f));
+        double rms_db = 20.0 * std::log10(std::max(meter.rms, 1e-9f));
+        mvprintw(top + height + c, 4, "%s %s 峰值 %6.1f | RMS %6.1f dB", names[c], bar.c_str(),
+                 std::max(peak_db, -99.9), std::max(rms_db, -99.9));
+    }
 }
 
 // --- 渲染函数 ---
 void renderPlaying() {
-    auto& player = ctrl.getPlayer();
+    auto& player = ctrl->getPlayer();
     std::string mode_name;
-    switch (ctrl.mode) {
+    switch (ctrl->mode) {
         case PlayMode::SEQUENTIAL:
             mode_name = "顺序";
             break;
@@ -90,17 +133,18 @@ void renderPlaying() {
     
     // 显示当前歌单信息
     std::string playlist_name = "无歌单";
-    if (ctrl.currentPlaylistIndex >= 0 && ctrl.currentPlaylistIndex < (int)ctrl.playlists.size()) {
-        playlist_name = ctrl.playlists[ctrl.currentPlaylistIndex]->name;
+    if (ctrl->currentPlaylistIndex >= 0 && ctrl->currentPlaylistIndex < (int)ctrl->playlists.size()) {
+        playlist_name = ctrl->playlists[ctrl->currentPlaylistIndex]->name;
     }
     
     // 获取当前音量（使用不锁定的版本，因为已经在锁中）
-    int volume = ctrl.getVolumeUnlocked();
+    int volume = ctrl->getVolumeUnlocked();
     
-    mvprintw(1, 2, "歌单: %s | 模式: %s | 音量: %d%%", playlist_name.c_str(), mode_name.c_str(), volume);
+    mvprintw(1, 2, "歌单: %s | 模式: %s | 音量: %d%%",
+             TextLayout::shared().truncate(playlist_name, std::max(8, COLS - 40)).c_str(), mode_name.c_str(), volume);
 
-    if (ctrl.currentPlaylistIndex < 0 || ctrl.currentPlaylistIndex >= (int)ctrl.playlists.size() || 
-        ctrl.playlists[ctrl.currentPlaylistIndex]->empty()) {
+    if (ctrl->currentPlaylistIndex < 0 || ctrl->currentPlaylistIndex >= (int)ctrl->playlists.size() || 
+        ctrl->playlists[ctrl->currentPlaylistIndex]->empty()) {
         mvprintw(LINES / 2, (COLS - 20) / 2, "--- 暂无歌曲 ---");
         mvprintw(LINES / 2 + 1, (COLS - 30) / 2, "请按 [M] 进入菜单选择歌单");
     } else {
@@ -109,12 +153,19 @@ void renderPlaying() {
         double elapsed = player.getElapsedSeconds();
         
         // 获取歌曲基本信息（从AppController获取，考虑乱序模式）
-        auto& song_info = ctrl.getCurrentSong();
+        auto& song_info = ctrl->getCurrentSong();
 
-        mvprintw(3, 2, "[%d/%d] %s - %s",
-                 ctrl.currentSongIndex + 1, ctrl.getCurrentPlaylistSize(),
-                 song_info.title.c_str(), song_info.artist.c_str());
+        char index_text[32];
+        snprintf(index_text, sizeof(index_text), "[%d/%d] ", ctrl->currentSongIndex + 1, ctrl->getCurrentPlaylistSize());
+        std::string title_line = index_text + song_info.title + " - " + song_info.artist;
+        mvprintw(3, 2, "%s", TextLayout::shared().truncate(title_line, COLS - 4).c_str());
 
+        // 屏幕足够高时在歌词和进度条之间显示频谱和电平表
+        int spectrum_height = std::min(8, LINES - 22);
+        bool show_visualizer = spectrum_height >= 3;
+        int visualizer_top = LINES - 7 - spectrum_height;
+        int lyric_bottom = show_visualizer ? visualizer_top - 1 : LINES - 4;
+        
         // 歌词显示
         if (player_song.lyrics.empty()) {
             // 只有当歌曲播放时间超过0.1秒且仍然没有歌词时，才显示"未找到歌词"
@@ -126,72 +177,40 @@ void renderPlaying() {
             }
             // 如果elapsed <= 0.1，不显示任何内容，给歌词加载留出时间
         } else {
-            int lyricIdx = -1;
-            for (int i = 0; i < (int)player_song.lyrics.size(); ++i) {
-                if (elapsed >= player_song.lyrics[i].timestamp)
-                    lyricIdx = i;
-                else
-                    break;
-            }
-            
-            // 计算最大显示宽度（考虑屏幕宽度和前缀）
+            // 歌词或终端宽度改变时才重新折行，当前行用游标/二分查找
             int max_width = COLS - 10; // 留出边距
-            
-            // 显示三句歌词：上一句、当前句、下一句
-            // 动态计算起始行，确保歌词显示在屏幕中央区域
-            int max_lyric_lines = LINES - 12; // 留出标题、进度条等空间
+            lyric_layout.update(player_song.lyrics, max_width);
+            int lyricIdx = lyric_layout.lineAt((int64_t)(elapsed * 1000.0));
             int start_y = 6; // 从第6行开始显示歌词
             
-            // 先计算三句歌词总共需要多少行
-            int total_lines_needed = 0;
-            for (int offset = -1; offset <= 1; ++offset) {
-                int idx = lyricIdx + offset;
-                if (idx >= 0 && idx < (int)player_song.lyrics.size()) {
-                    std::string lyric_text = player_song.lyrics[idx].text;
-                    std::vector<std::string> lines = splitLyricLines(lyric_text, max_width);
-                    total_lines_needed += lines.size() + 1; // 歌词行数 + 间隔行
-                } else {
-                    total_lines_needed += 1; // 没有歌词时也留出间隔行
-                }
-            }
-            
-            // 如果总行数超过可用空间，调整起始位置
-            if (total_lines_needed > max_lyric_lines) {
-                // 简单处理：从顶部开始显示，能显示多少就显示多少
-                start_y = 6;
-            }
-            
+            // 显示三句歌词：上一句、当前句、下一句
             // 实际显示歌词
             for (int offset = -1; offset <= 1; ++offset) {
                 int idx = lyricIdx + offset;
-                if (idx >= 0 && idx < (int)player_song.lyrics.size()) {
-                    std::string lyric_text = player_song.lyrics[idx].text;
-                    std::vector<std::string> lines = splitLyricLines(lyric_text, max_width);
-                    
-                    // 计算当前句歌词的显示行数
-                    int line_count = lines.size();
+                if (idx >= 0 && idx < lyric_layout.lineCount()) {
+                    int line_count = lyric_layout.rowCount(idx);
                     
                     // 显示当前句歌词的所有行
                     for (int line_idx = 0; line_idx < line_count; ++line_idx) {
                         int y_pos = start_y + line_idx;
                         
                         // 确保不会超出屏幕
-                        if (y_pos >= LINES - 4) break;
+                        if (y_pos >= lyric_bottom) break;
                         
                         if (offset == 0) {
                             // 当前歌词：高亮显示
                             attron(COLOR_PAIR(1) | A_BOLD);
                             if (line_idx == 0) {
                                 // 第一行显示前缀
-                                mvprintw(y_pos, 4, ">> %s", lines[line_idx].c_str());
+                                mvprintw(y_pos, 4, ">> %s", lyric_layout.row(idx, line_idx).c_str());
                             } else {
                                 // 后续行缩进对齐
-                                mvprintw(y_pos, 7, "%s", lines[line_idx].c_str());
+                                mvprintw(y_pos, 7, "%s", lyric_layout.row(idx, line_idx).c_str());
                             }
                             attroff(COLOR_PAIR(1) | A_BOLD);
                         } else {
                             // 上一句或下一句歌词：普通显示
-                            mvprintw(y_pos, 7, "%s", lines[line_idx].c_str());
+                            mvprintw(y_pos, 7, "%s", lyric_layout.row(idx, line_idx).c_str());
                         }
                     }
                     
@@ -206,12 +225,28 @@ void renderPlaying() {
             }
         }
 
-        // 进度条
+        if (show_visualizer) {
+            renderVisualizer(visualizer_top, spectrum_height);
+        }
+        
+        // 进度条：有波形概要时按各段响度绘制波形，已播放部分高亮
         int barWidth = std::max(10, COLS - 20);
         int pos = (player_song.duration > 0) ? (int)(elapsed / player_song.duration * barWidth) : 0;
         mvprintw(LINES - 2, 2, "%02d:%02d [", (int)elapsed / 60, (int)elapsed % 60);
-        for (int i = 0; i < barWidth; ++i)
-            addch(i < pos ? '=' : (i == pos ? '>' : ' '));
+        auto waveform = ctrl->getWaveform();
+        if (waveform) {
+            for (int i = 0; i < barWidth; ++i) {
+                float amplitude = waveform->amplitude((double)i / barWidth, (double)(i + 1) / barWidth);
+                int level = std::max(1, std::min(8, (int)std::ceil(amplitude * 8)));
+                attr_t attr = i < pos ? (COLOR_PAIR(1) | A_BOLD) : (i == pos ? A_REVERSE : A_DIM);
+                attron(attr);
+                printw("%s", kVerticalBlocks[level]);
+                attroff(attr);
+            }
+        } else {
+            for (int i = 0; i < barWidth; ++i)
+                addch(i < pos ? '=' : (i == pos ? '>' : ' '));
+        }
         printw("] %02d:%02d", (int)player_song.duration / 60, (int)player_song.duration % 60);
     }
     mvprintw(LINES - 4, 2, "[H]帮助");
@@ -232,11 +267,8 @@ void renderPlaylistManager() {
     std::vector<std::string> options;
     
     // 添加歌单列表
-    for (const auto& playlist : ctrl.playlists) {
-        char buffer[128];
-        snprintf(buffer, sizeof(buffer), "%s (%zu 首)", 
-                playlist->name.c_str(), playlist->size());
-        options.push_back(buffer);
+    for (const auto& playlist : ctrl->playlists) {
+        options.push_back(playlist->name + " (" + std::to_string(playlist->size()) + " 首)");
     }
     
     // 添加功能选项（如果有歌单，添加分隔线）
@@ -247,16 +279,27 @@ void renderPlaylistManager() {
     options.push_back("返回主菜单");
     
     drawPageMenu("歌单管理器", options, playlist_manager_page, false);
+    
+    // 显示正在进行的目录导入进度，或最近一次导入的统计
+    if (ctrl->isImporting()) {
+        const ScanProgress& progress = ctrl->getImportProgress();
+        mvprintw(LINES - 3, 2, "正在导入: 已读取 %zu / %zu 个文件...",
+                 progress.read.load(), progress.found.load());
+    } else if (ctrl->lastScanStats.files > 0) {
+        mvprintw(LINES - 3, 2, "上次导入: %zu 个文件, 耗时 %.1f 秒 (%.0f 个/秒, %u 线程)",
+                 ctrl->lastScanStats.files, ctrl->lastScanStats.seconds,
+                 ctrl->lastScanStats.filesPerSecond(), ctrl->lastScanStats.threads);
+    }
 }
 
 // 简化版本 - 只确保编译通过
 void renderPlaylistMenu() {
     if (current_selected_playlist_index < 0 || 
-        current_selected_playlist_index >= (int)ctrl.playlists.size()) {
+        current_selected_playlist_index >= (int)ctrl->playlists.size()) {
         return;
     }
     
-    auto& playlist = ctrl.playlists[current_selected_playlist_index];
+    auto& playlist = ctrl->playlists[current_selected_playlist_index];
     std::vector<std::string> options = {
         "播放此歌单",
         "浏览歌曲",
@@ -266,69 +309,36 @@ void renderPlaylistMenu() {
         "返回歌单管理器"
     };
     
-    char title[128];
-    snprintf(title, sizeof(title), "歌单: %s (%zu 首)", playlist->name.c_str(), playlist->size());
+    std::string title = "歌单: " + playlist->name + " (" + std::to_string(playlist->size()) + " 首)";
     drawPageMenu(title, options, playlist_menu_page, false);
 }
 
 void renderPlaylistView() {
     if (current_selected_playlist_index < 0 || 
-        current_selected_playlist_index >= (int)ctrl.playlists.size()) {
+        current_selected_playlist_index >= (int)ctrl->playlists.size()) {
         return;
     }
     
-    auto& playlist = ctrl.playlists[current_selected_playlist_index];
-    std::vector<std::string> options;
+    auto& playlist = ctrl->playlists[current_selected_playlist_index];
     
-    // 歌单浏览：总是显示原始顺序
-    for (const auto& song : playlist->getSongs()) {
-        char buffer[256];
-        snprintf(buffer, sizeof(buffer), "%s - %s", 
-                song.title.c_str(), song.artist.c_str());
-        options.push_back(buffer);
-    }
+    std::string title = "歌单浏览: " + playlist->name + " (" + std::to_string(playlist->size()) + " 首)";
     
     // 如果没有歌曲，显示提示
-    if (options.empty()) {
-        options.push_back("--- 暂无歌曲 ---");
+    if (playlist->empty()) {
+        drawPageMenu(title, {"--- 暂无歌曲 ---"}, playlist_view_page, false);
+        return;
     }
     
-    char title[128];
-    snprintf(title, sizeof(title), "歌单浏览: %s (%zu 首)", 
-             playlist->name.c_str(), playlist->size());
-    drawPageMenu(title, options, playlist_view_page, false);
+    // 歌单浏览：总是显示原始顺序，只格式化可见行
+    const auto& songs = playlist->getSongs();
+    drawPageMenu(title, (int)songs.size(), [&songs](int i) {
+        return songs[i].title + " - " + songs[i].artist;
+    }, playlist_view_page, false);
 }
 
 void renderCurrentPlaylistView() {
-    std::vector<std::string> options;
-    
-    // 检查是否有当前播放的歌单
-    if (ctrl.currentPlaylistIndex < 0 || ctrl.currentPlaylistIndex >= (int)ctrl.playlists.size()) {
-        options.push_back("--- 暂无播放列表 ---");
-        options.push_back("请先选择一个歌单进行播放");
-    } else {
-        auto& playlist = ctrl.playlists[ctrl.currentPlaylistIndex];
-        
-        // 当前播放列表：根据播放模式显示
-        bool is_shuffled = (ctrl.getPlayMode() == PlayMode::SHUFFLE);
-        
-        for (int i = 0; i < (int)playlist->size(); ++i) {
-            const auto& song = ctrl.getSongAt(i); // 这个函数已经考虑了乱序模式
-            char buffer[256];
-            snprintf(buffer, sizeof(buffer), "%s - %s", 
-                    song.title.c_str(), song.artist.c_str());
-            options.push_back(buffer);
-        }
-        
-        // 如果没有歌曲，显示提示
-        if (options.empty()) {
-            options.push_back("--- 歌单为空 ---");
-        }
-    }
-    
-    char title[128];
     std::string mode_name;
-    switch (ctrl.getPlayMode()) {
+    switch (ctrl->getPlayMode()) {
         case PlayMode::SEQUENTIAL:
             mode_name = "顺序";
             break;
@@ -340,32 +350,51 @@ void renderCurrentPlaylistView() {
             break;
     }
     std::string playlist_name = "无歌单";
-    if (ctrl.currentPlaylistIndex >= 0 && ctrl.currentPlaylistIndex < (int)ctrl.playlists.size()) {
-        playlist_name = ctrl.playlists[ctrl.currentPlaylistIndex]->name;
+    if (ctrl->currentPlaylistIndex >= 0 && ctrl->currentPlaylistIndex < (int)ctrl->playlists.size()) {
+        playlist_name = ctrl->playlists[ctrl->currentPlaylistIndex]->name;
+    }
+    std::string title = "当前播放列表: " + playlist_name + " (" + mode_name + ")";
+    
+    // 检查是否有当前播放的歌单
+    if (ctrl->currentPlaylistIndex < 0 || ctrl->currentPlaylistIndex >= (int)ctrl->playlists.size()) {
+        drawPageMenu(title, {"--- 暂无播放列表 ---", "请先选择一个歌单进行播放"},
+                     current_playlist_page, false);
+        return;
+    }
+    
+    auto& playlist = ctrl->playlists[ctrl->currentPlaylistIndex];
+    
+    // 如果没有歌曲，显示提示
+    if (playlist->empty()) {
+        drawPageMenu(title, {"--- 歌单为空 ---"}, current_playlist_page, false);
+        return;
     }
-    snprintf(title, sizeof(title), "当前播放列表: %s (%s)", 
-             playlist_name.c_str(), mode_name.c_str());
-    drawPageMenu(title, options, current_playlist_page, false);
+    
+    // 当前播放列表：根据播放模式显示，只格式化可见行
+    drawPageMenu(title, (int)playlist->size(), [](int i) {
+        const auto& song = ctrl->getSongAt(i); // 这个函数已经考虑了乱序模式
+        return song.title + " - " + song.artist;
+    }, current_playlist_page, false);
 }
 
 void renderSongOperationMenu() {
     if (current_selected_playlist_index < 0 || 
-        current_selected_playlist_index >= (int)ctrl.playlists.size() ||
+        current_selected_playlist_index >= (int)ctrl->playlists.size() ||
         current_operating_song_index < 0) {
         return;
     }
     
-    auto& playlist = ctrl.playlists[current_selected_playlist_index];
+    auto& playlist = ctrl->playlists[current_selected_playlist_index];
     if (current_operating_song_index >= (int)playlist->size()) {
         return;
     }
     
     // 获取歌曲信息（考虑当前是否在浏览当前播放的歌单）
     const SongEntry* song_ptr = nullptr;
-    if (current_selected_playlist_index == ctrl.currentPlaylistIndex && 
-        ctrl.currentPlaylistIndex >= 0) {
+    if (current_selected_playlist_index == ctrl->currentPlaylistIndex && 
+        ctrl->currentPlaylistIndex >= 0) {
         // 如果是当前播放的歌单，使用AppController的接口（考虑乱序模式）
-        song_ptr = &ctrl.getSongAt(current_operating_song_index);
+        song_ptr = &ctrl->getSongAt(current_operating_song_index);
     } else {
         // 其他歌单，直接访问
         if (current_operating_song_index >= 0 && 
@@ -374,10 +403,9 @@ void renderSongOperationMenu() {
         }
     }
     
-    char song_info[256] = "未知歌曲";
+    std::string song_info = "未知歌曲";
     if (song_ptr) {
-        snprintf(song_info, sizeof(song_info), "%s - %s", 
-                 song_ptr->title.c_str(), song_ptr->artist.c_str());
+        song_info = song_ptr->title + " - " + song_ptr->artist;
     }
     
     std::vector<std::string> options = {
@@ -387,29 +415,26 @@ void renderSongOperationMenu() {
         "返回歌曲列表"
     };
     
-    char title[256];
-    snprintf(title, sizeof(title), "歌曲操作: %s", song_info);
+    std::string title = "歌曲操作: " + song_info;
     drawPageMenu(title, options, main_menu_page, false); // 使用main_menu_page作为临时页面
 }
 
 void renderCurrentPlaylistSongMenu() {
     // 检查是否有当前播放的歌单
-    if (ctrl.currentPlaylistIndex < 0 || ctrl.currentPlaylistIndex >= (int)ctrl.playlists.size() ||
+    if (ctrl->currentPlaylistIndex < 0 || ctrl->currentPlaylistIndex >= (int)ctrl->playlists.size() ||
         current_playlist_song_index < 0) {
         return;
     }
     
-    auto& playlist = ctrl.playlists[ctrl.currentPlaylistIndex];
+    auto& playlist = ctrl->playlists[ctrl->currentPlaylistIndex];
     if (current_playlist_song_index >= (int)playlist->size()) {
         return;
     }
     
     // 获取歌曲信息（考虑乱序模式）
-    const SongEntry& song = ctrl.getSongAt(current_playlist_song_index);
+    const SongEntry& song = ctrl->getSongAt(current_playlist_song_index);
     
-    char song_info[256];
-    snprintf(song_info, sizeof(song_info), "%s - %s", 
-             song.title.c_str(), song.artist.c_str());
+    std::string song_info = song.title + " - " + song.artist;
     
     std::vector<std::string> options = {
         "播放此歌曲",
@@ -418,8 +443,7 @@ void renderCurrentPlaylistSongMenu() {
         "返回播放列表"
     };
     
-    char title[256];
-    snprintf(title, sizeof(title), "播放列表歌曲操作: %s", song_info);
+    std::string title = "播放列表歌曲操作: " + song_info;
     drawPageMenu(title, options, main_menu_page, false); // 使用main_menu_page作为临时页面
 }
 
@@ -434,7 +458,7 @@ void renderPlaylistEdit() {
 
 void renderAddToPlaylist() {
     std::vector<std::string> options;
-    for (const auto& playlist : ctrl.playlists) {
+    for (const auto& playlist : ctrl->playlists) {
         options.push_back(playlist->name);
     }
     options.push_back("--- 功能 ---");
@@ -455,11 +479,39 @@ void renderSortMenu() {
 }
 
 void renderSettings() {
+    char crossfade_option[64];
+    if (ctrl->getCrossfadeSeconds() > 0) {
+        snprintf(crossfade_option, sizeof(crossfade_option), "淡入淡出 (%d 秒)", ctrl->getCrossfadeSeconds());
+    } else {
+        snprintf(crossfade_option, sizeof(crossfade_option), "淡入淡出 (关闭)");
+    }
+    std::string gain_option = "音量均衡 (" + replayGainModeName(ctrl->getReplayGainMode()) + ")";
+    std::string eq_option = "均衡器 (关闭)";
+    const auto& presets = ctrl->getEqualizerPresets();
+    int preset_index = ctrl->getEqualizerPresetIndex();
+    if (ctrl->isEqualizerEnabled() && preset_index >= 0 && preset_index < (int)presets.size()) {
+        eq_option = "均衡器 (" + presets[preset_index].name + ")";
+    }
     std::vector<std::string> options = {
         "播放模式",
+        crossfade_option,
+        gain_option,
+        eq_option,
         "返回主菜单"
     };
     drawPageMenu("设置", options, main_menu_page, false);
+    
+    // 显示输出缓冲状态
+    auto& player = ctrl->getPlayer();
+    const AudioDeviceConfig& device = player.getDeviceConfig();
+    mvprintw(LINES - 3, 2, "输出设备: %d Hz%s | %s | %d 帧 (%.1f ms) | 增益内核: %s",
+             player.getOutputRate(), device.sampleRate == 0 ? " (自动)" : "",
+             MusicPlayer::formatName(device.format), player.getDeviceBufferFrames(),
+             player.getDeviceBufferFrames() * 1000.0 / player.getOutputRate(),
+             player.getGainKernelName());
+    mvprintw(LINES - 2, 2, "音频缓冲: %.2f 秒 (%.0f%%) | 断流: %llu 次",
+             player.getBufferedSeconds(), player.getBufferFill() * 100.0,
+             (unsigned long long)player.getUnderrunCount());
 }
 
 void renderSortOrderMenu() {
@@ -481,33 +533,95 @@ void renderPlayMode() {
     drawPageMenu("播放模式", options, main_menu_page, false);
 }
 
+void renderReplayGain() {
+    std::vector<std::string> options = {
+        replayGainModeName(ReplayGainMode::OFF),
+        replayGainModeName(ReplayGainMode::TRACK),
+        replayGainModeName(ReplayGainMode::ALBUM),
+        "返回设置"
+    };
+    drawPageMenu("音量均衡", options, main_menu_page, false);
+    
+    // 显示后台响度分析进度
+    LoudnessStats stats = ctrl->getLoudnessStats();
+    if (stats.pending > 0) {
+        mvprintw(LINES - 3, 2, "响度分析中: 已处理 %zu 首, 剩余 %zu 首 (%.1f 首/秒, %u 线程)",
+                 stats.processed, stats.pending, stats.tracksPerSecond(), stats.threads);
+    } else if (stats.processed > 0) {
+        mvprintw(LINES - 3, 2, "响度分析完成: %zu 首 (其中解码分析 %zu 首), 耗时 %.1f 秒 (%.1f 首/秒)",
+                 stats.processed, stats.analyzed, stats.seconds, stats.tracksPerSecond());
+    }
+    float gain = ctrl->getPlayer().getTrackGain();
+    mvprintw(LINES - 2, 2, "当前歌曲增益: %+.1f dB", 20.0 * std::log10(std::max(gain, 1e-6f)));
+}
+
+void renderEqualizer() {
+    const auto& presets = ctrl->getEqualizerPresets();
+    int current = ctrl->getEqualizerPresetIndex();
+    std::vector<std::string> options;
+    options.push_back(ctrl->isEqualizerEnabled() ? "均衡器: 开启" : "均衡器: 关闭");
+    for (int i = 0; i < (int)presets.size(); ++i) {
+        options.push_back((i == current ? "* " : "  ") + presets[i].name);
+    }
+    options.push_back("返回设置");
+    drawPageMenu("均衡器", options, main_menu_page, false);
+    
+    // 显示当前预设的频段和 DSP 处理耗时
+    if (current >= 0 && current < (int)presets.size()) {
+        const EqPreset& preset = presets[current];
+        std::string bands;
+        char buf[64];
+        snprintf(buf, sizeof(buf), "前级 %+.1f dB", preset.preamp);
+        bands += buf;
+        for (const auto& band : preset.bands) {
+            const char* type = band.type == EqBandType::LOW_SHELF ? "低架" :
+                               band.type == EqBandType::HIGH_SHELF ? "高架" : "峰值";
+            snprintf(buf, sizeof(buf), " | %s %.0f Hz %+.1f dB", type, band.frequency, band.gain);
+            bands += buf;
+        }
+        mvprintw(LINES - 3, 2, "%s", TextLayout::shared().truncate(bands, COLS - 4).c_str());
+    }
+    DspStats stats = ctrl->getPlayer().getDspStats();
+    mvprintw(LINES - 2, 2, "DSP 耗时: 平均 %.1f µs / 峰值 %.1f µs 每缓冲区 | 占用 %.2f%%",
+             stats.averageMicros, stats.peakMicros, stats.load * 100.0);
+}
+
+void renderCrossfade() {
+    std::vector<std::string> options = {"关闭"};
+    for (int i = 1; i <= MusicPlayer::kMaxCrossfadeSeconds; ++i) {
+        options.push_back(std::to_string(i) + " 秒");
+    }
+    options.push_back("返回设置");
+    drawPageMenu("淡入淡出时长", options, main_menu_page, false);
+}
+
 // --- 输入处理 ---
 void handlePlayingInput(int ch) {
     if (ch == 'm' || ch == 'M') {
-        ctrl.state = AppState::MAIN_MENU;
+        ctrl->state = AppState::MAIN_MENU;
         main_menu_page.selected_index = 0;
     } else if (ch == ' ') {
-        ctrl.togglePause();
+        ctrl->togglePause();
     } else if (ch == KEY_RIGHT) {
-        ctrl.nextSong();
+        ctrl->nextSong();
     } else if (ch == KEY_LEFT) {
-        ctrl.prevSong();
+        ctrl->prevSong();
     } else if (ch == ']' || ch == '}') {
-        ctrl.seekForward();
+        ctrl->seekForward();
     } else if (ch == '[' || ch == '{') {
-        ctrl.seekBackward();
+        ctrl->seekBackward();
     } else if (ch == 'a' || ch == 'A') {
-        if (!ctrl.getCurrentSongPath().empty()) {
-            ctrl.state = AppState::ADD_TO_PLAYLIST;
+        if (!ctrl->getCurrentSongPath().empty()) {
+            ctrl->state = AppState::ADD_TO_PLAYLIST;
             add_to_playlist_page.selected_index = 0;
-            add_to_playlist_page.update(ctrl.playlists.size());
+            add_to_playlist_page.update(ctrl->playlists.size());
         }
     } else if (ch == 'h' || ch == 'H') {
         enterHelp();
     } else if (ch == '-' || ch == '_') { // -键（减号）
-        ctrl.decreaseVolume();
+        ctrl->decreaseVolume();
     } else if (ch == '=' || ch == '+') { // =键（未按shift）或+键（按shift）
-        ctrl.increaseVolume();
+        ctrl->increaseVolume();
     }
 }
 
@@ -523,16 +637,16 @@ void handleMainMenuInput(int ch) {
     } else if (ch == '\n' || ch == 13) {
         switch (main_menu_page.selected_index) {
             case 0:
-                ctrl.state = AppState::PLAYING;
+                ctrl->state = AppState::PLAYING;
                 break;
             case 1:
                 // 当前播放列表：浏览当前播放的歌单（考虑播放模式）
-                ctrl.state = AppState::CURRENT_PLAYLIST_VIEW;
-                if (ctrl.currentPlaylistIndex >= 0 && ctrl.currentPlaylistIndex < (int)ctrl.playlists.size()) {
-                    auto& playlist = ctrl.playlists[ctrl.currentPlaylistIndex];
+                ctrl->state = AppState::CURRENT_PLAYLIST_VIEW;
+                if (ctrl->currentPlaylistIndex >= 0 && ctrl->currentPlaylistIndex < (int)ctrl->playlists.size()) {
+                    auto& playlist = ctrl->playlists[ctrl->currentPlaylistIndex];
                     current_playlist_page.update(playlist->size());
                     current_playlist_page.current_page = 0;
-                    current_playlist_page.selected_index = ctrl.currentSongIndex; // 选中当前播放的歌曲
+                    current_playlist_page.selected_index = ctrl->currentSongIndex; // 选中当前播放的歌曲
                 } else {
                     current_playlist_page.update(0);
                     current_playlist_page.current_page = 0;
@@ -540,26 +654,26 @@ void handleMainMenuInput(int ch) {
                 }
                 break;
             case 2:
-                ctrl.state = AppState::PLAYLIST_MANAGER;
+                ctrl->state = AppState::PLAYLIST_MANAGER;
                 playlist_manager_page.selected_index = 0;
-                playlist_manager_page.update(ctrl.playlists.size());
+                playlist_manager_page.update(ctrl->playlists.size());
                 break;
             case 3:
                 // 添加到歌单
-                if (ctrl.currentPlaylistIndex >= 0 && ctrl.currentPlaylistIndex < (int)ctrl.playlists.size()) {
-                    auto& current_playlist = ctrl.playlists[ctrl.currentPlaylistIndex];
-                    if (ctrl.currentSongIndex >= 0 && ctrl.currentSongIndex < (int)current_playlist->size()) {
+                if (ctrl->currentPlaylistIndex >= 0 && ctrl->currentPlaylistIndex < (int)ctrl->playlists.size()) {
+                    auto& current_playlist = ctrl->playlists[ctrl->currentPlaylistIndex];
+                    if (ctrl->currentSongIndex >= 0 && ctrl->currentSongIndex < (int)current_playlist->size()) {
                         // 清空歌曲路径，表示添加当前播放的歌曲
                         song_to_add_path = "";
                         // 进入添加到歌单界面
-                        ctrl.state = AppState::ADD_TO_PLAYLIST;
+                        ctrl->state = AppState::ADD_TO_PLAYLIST;
                         add_to_playlist_page.selected_index = 0;
-                        add_to_playlist_page.update(ctrl.playlists.size());
+                        add_to_playlist_page.update(ctrl->playlists.size());
                     }
                 }
                 break;
             case 4:
-                ctrl.state = AppState::SETTINGS_MENU;
+                ctrl->state = AppState::SETTINGS_MENU;
                 main_menu_page.selected_index = 0;
                 break;
         }
@@ -567,7 +681,7 @@ void handleMainMenuInput(int ch) {
         enterHelp();
     } else if (ch == 'q' || ch == 'Q') {
         // Q键返回播放界面
-        ctrl.state = AppState::PLAYING;
+        ctrl->state = AppState::PLAYING;
     }
 }
 
@@ -576,8 +690,8 @@ void handlePlaylistManagerInput(int ch) {
         playlist_manager_page.moveUp();
         // 如果选中了分隔线，继续向上移动
         int selected = playlist_manager_page.selected_index;
-        int playlist_count = ctrl.playlists.size();
-        if (!ctrl.playlists.empty() && selected == playlist_count) {
+        int playlist_count = ctrl->playlists.size();
+        if (!ctrl->playlists.empty() && selected == playlist_count) {
             // 选中了分隔线，向上移动一位
             playlist_manager_page.selected_index = playlist_count - 1;
         }
@@ -585,8 +699,8 @@ void handlePlaylistManagerInput(int ch) {
         playlist_manager_page.moveDown();
         // 如果选中了分隔线，继续向下移动
         int selected = playlist_manager_page.selected_index;
-        int playlist_count = ctrl.playlists.size();
-        if (!ctrl.playlists.empty() && selected == playlist_count) {
+        int playlist_count = ctrl->playlists.size();
+        if (!ctrl->playlists.empty() && selected == playlist_count) {
             // 选中了分隔线，向下移动一位
             playlist_manager_page.selected_index = playlist_count + 1;
         }
@@ -596,32 +710,34 @@ void handlePlaylistManagerInput(int ch) {
         playlist_manager_page.nextPage();
     } else if (ch == '\n' || ch == 13) {
         int selected = playlist_manager_page.selected_index;
-        int playlist_count = ctrl.playlists.size();
+        int playlist_count = ctrl->playlists.size();
         
         // 计算功能选项的偏移（考虑分隔线）
-        int separator_offset = (!ctrl.playlists.empty()) ? 1 : 0;
+        int separator_offset = (!ctrl->playlists.empty()) ? 1 : 0;
         
         if (selected < playlist_count) {
             // 选择歌单 - 进入歌单功能菜单
-            ctrl.state = AppState::PLAYLIST_MENU;
+            ctrl->state = AppState::PLAYLIST_MENU;
             current_selected_playlist_index = selected;
-            // 注意：这里不更新 ctrl.currentPlaylistIndex
+            // 启动时歌单内容在后台读入，打开时若还没读到就立即读取
+            ctrl->loadPlaylistNow(selected);
+            // 注意：这里不更新 ctrl->currentPlaylistIndex
             // currentPlaylistIndex 只在用户选择"播放此歌单"时才更新
             // 重置页面菜单状态，从第一个选项开始
             playlist_menu_page.current_page = 0;
             playlist_menu_page.selected_index = 0;
         } else if (selected == playlist_count + separator_offset) {
             // "创建歌单"选项（跳过分隔线）
-            ctrl.state = AppState::PLAYLIST_EDIT;
+            ctrl->state = AppState::PLAYLIST_EDIT;
             playlist_edit_page.selected_index = 0;
         } else if (selected == playlist_count + separator_offset + 1) {
             // "返回主菜单"选项
-            ctrl.state = AppState::MAIN_MENU;
+            ctrl->state = AppState::MAIN_MENU;
         }
     } else if (ch == 'h' || ch == 'H') {
         enterHelp();
     } else if (ch == 'q' || ch == 'Q') {
-        ctrl.state = AppState::MAIN_MENU;
+        ctrl->state = AppState::MAIN_MENU;
     }
 }
 
@@ -639,22 +755,22 @@ void handlePlaylistMenuInput(int ch) {
             case 0:
                 // 播放此歌单
                 if (current_selected_playlist_index >= 0 && 
-                    current_selected_playlist_index < (int)ctrl.playlists.size()) {
-                    auto& playlist = ctrl.playlists[current_selected_playlist_index];
+                    current_selected_playlist_index < (int)ctrl->playlists.size()) {
+                    auto& playlist = ctrl->playlists[current_selected_playlist_index];
                     if (!playlist->empty()) {
-                        ctrl.currentPlaylistIndex = current_selected_playlist_index;
-                        ctrl.currentSongIndex = 0;
-                        ctrl.requestLoad(); // 请求加载歌曲
-                        ctrl.state = AppState::PLAYING;
+                        ctrl->currentPlaylistIndex = current_selected_playlist_index;
+                        ctrl->currentSongIndex = 0;
+                        ctrl->requestLoad(); // 请求加载歌曲
+                        ctrl->state = AppState::PLAYING;
                     }
                 }
                 break;
             case 1:
                 // 浏览歌曲
-                ctrl.state = AppState::PLAYLIST_VIEW;
+                ctrl->state = AppState::PLAYLIST_VIEW;
                 if (current_selected_playlist_index >= 0 && 
-                    current_selected_playlist_index < (int)ctrl.playlists.size()) {
-                    auto& playlist = ctrl.playlists[current_selected_playlist_index];
+                    current_selected_playlist_index < (int)ctrl->playlists.size()) {
+                    auto& playlist = ctrl->playlists[current_selected_playlist_index];
                     playlist_view_page.update(playlist->size());
                     playlist_view_page.current_page = 0;
                     playlist_view_page.selected_index = 0;
@@ -663,38 +779,38 @@ void handlePlaylistMenuInput(int ch) {
             case 2:
                 // 重命名歌单
                 if (current_selected_playlist_index >= 0 && 
-                    current_selected_playlist_index < (int)ctrl.playlists.size()) {
+                    current_selected_playlist_index < (int)ctrl->playlists.size()) {
                     std::string new_name = inputField("输入新名称: ");
                     if (!new_name.empty()) {
-                        ctrl.renamePlaylist(current_selected_playlist_index, new_name);
+                        ctrl->renamePlaylist(current_selected_playlist_index, new_name);
                     }
                 }
                 break;
             case 3:
                 // 排序歌单
-                ctrl.state = AppState::PLAYLIST_SORT;
+                ctrl->state = AppState::PLAYLIST_SORT;
                 sort_menu_page.selected_index = 0;
                 break;
             case 4:
                 // 删除歌单
                 if (current_selected_playlist_index >= 0 && 
-                    current_selected_playlist_index < (int)ctrl.playlists.size()) {
-                    ctrl.deletePlaylist(current_selected_playlist_index);
-                    ctrl.state = AppState::PLAYLIST_MANAGER;
-                    playlist_manager_page.update(ctrl.playlists.size());
+                    current_selected_playlist_index < (int)ctrl->playlists.size()) {
+                    ctrl->deletePlaylist(current_selected_playlist_index);
+                    ctrl->state = AppState::PLAYLIST_MANAGER;
+                    playlist_manager_page.update(ctrl->playlists.size());
                     current_selected_playlist_index = -1;
                 }
                 break;
             case 5:
                 // 返回歌单管理器
-                ctrl.state = AppState::PLAYLIST_MANAGER;
+                ctrl->state = AppState::PLAYLIST_MANAGER;
                 current_selected_playlist_index = -1;
                 break;
         }
     } else if (ch == 'h' || ch == 'H') {
         enterHelp();
     } else if (ch == 'q' || ch == 'Q') {
-        ctrl.state = AppState::PLAYLIST_MANAGER;
+        ctrl->state = AppState::PLAYLIST_MANAGER;
         current_selected_playlist_index = -1;
     }
 }
@@ -702,15 +818,15 @@ void handlePlaylistMenuInput(int ch) {
 void handlePlaylistViewInput(int ch) {
     // 首先检查当前选择的歌单索引是否有效
     if (current_selected_playlist_index < 0 || 
-        current_selected_playlist_index >= (int)ctrl.playlists.size()) {
+        current_selected_playlist_index >= (int)ctrl->playlists.size()) {
         // 无效索引，返回歌单管理器
         if (ch == 'q' || ch == 'Q') {
-            ctrl.state = AppState::PLAYLIST_MANAGER;
+            ctrl->state = AppState::PLAYLIST_MANAGER;
         }
         return;
     }
     
-    auto& playlist = ctrl.playlists[current_selected_playlist_index];
+    auto& playlist = ctrl->playlists[current_selected_playlist_index];
     int song_count = playlist->size();
     
     if (ch == KEY_UP) {
@@ -727,27 +843,27 @@ void handlePlaylistViewInput(int ch) {
         if (selected < song_count) {
             // 记录选中的歌曲索引，然后打开歌曲操作菜单
             current_operating_song_index = selected;
-            ctrl.state = AppState::SONG_OPERATION_MENU;
+            ctrl->state = AppState::SONG_OPERATION_MENU;
         }
     } else if (ch == 'h' || ch == 'H') {
         enterHelp();
     } else if (ch == 'q' || ch == 'Q') {
         // 返回歌单功能菜单
-        ctrl.state = AppState::PLAYLIST_MENU;
+        ctrl->state = AppState::PLAYLIST_MENU;
     }
 }
 
 void handleCurrentPlaylistViewInput(int ch) {
     // 检查是否有当前播放的歌单
-    if (ctrl.currentPlaylistIndex < 0 || ctrl.currentPlaylistIndex >= (int)ctrl.playlists.size()) {
+    if (ctrl->currentPlaylistIndex < 0 || ctrl->currentPlaylistIndex >= (int)ctrl->playlists.size()) {
         // 没有当前播放的歌单，按Q返回主菜单
         if (ch == 'q' || ch == 'Q') {
-            ctrl.state = AppState::MAIN_MENU;
+            ctrl->state = AppState::MAIN_MENU;
         }
         return;
     }
     
-    auto& playlist = ctrl.playlists[ctrl.currentPlaylistIndex];
+    auto& playlist = ctrl->playlists[ctrl->currentPlaylistIndex];
     int song_count = playlist->size();
     
     if (ch == KEY_UP) {
@@ -764,13 +880,13 @@ void handleCurrentPlaylistViewInput(int ch) {
         if (selected < song_count) {
             // 记录选中的歌曲索引，然后打开歌曲操作菜单
             current_playlist_song_index = selected;
-            ctrl.state = AppState::CURRENT_PLAYLIST_SONG_MENU;
+            ctrl->state = AppState::CURRENT_PLAYLIST_SONG_MENU;
         }
     } else if (ch == 'h' || ch == 'H') {
         enterHelp();
     } else if (ch == 'q' || ch == 'Q') {
         // 返回主菜单
-        ctrl.state = AppState::MAIN_MENU;
+        ctrl->state = AppState::MAIN_MENU;
     }
 }
 
@@ -788,27 +904,27 @@ void handleSongOperationMenuInput(int ch) {
             case 0:
                 // 播放此歌曲
                 if (current_selected_playlist_index >= 0 && 
-                    current_selected_playlist_index < (int)ctrl.playlists.size() &&
+                    current_selected_playlist_index < (int)ctrl->playlists.size() &&
                     current_operating_song_index >= 0) {
-                    auto& playlist = ctrl.playlists[current_selected_playlist_index];
+                    auto& playlist = ctrl->playlists[current_selected_playlist_index];
                     if (current_operating_song_index < (int)playlist->size()) {
-                        ctrl.currentPlaylistIndex = current_selected_playlist_index;
-                        ctrl.currentSongIndex = current_operating_song_index;
-                        ctrl.requestLoad();
-                        ctrl.state = AppState::PLAYING;
+                        ctrl->currentPlaylistIndex = current_selected_playlist_index;
+                        ctrl->currentSongIndex = current_operating_song_index;
+                        ctrl->requestLoad();
+                        ctrl->state = AppState::PLAYING;
                     }
                 }
                 break;
             case 1:
                 // 从歌单删除
                 if (current_selected_playlist_index >= 0 && 
-                    current_selected_playlist_index < (int)ctrl.playlists.size() &&
+                    current_selected_playlist_index < (int)ctrl->playlists.size() &&
                     current_operating_song_index >= 0) {
-                    ctrl.removeSongFromPlaylist(current_selected_playlist_index, current_operating_song_index);
+                    ctrl->removeSongFromPlaylist(current_selected_playlist_index, current_operating_song_index);
                     // 返回歌曲列表
-                    ctrl.state = AppState::PLAYLIST_VIEW;
+                    ctrl->state = AppState::PLAYLIST_VIEW;
                     // 更新歌曲列表显示
-                    auto& playlist = ctrl.playlists[current_selected_playlist_index];
+                    auto& playlist = ctrl->playlists[current_selected_playlist_index];
                     playlist_view_page.update(playlist->size());
                     // 重置选中索引
                     if (playlist_view_page.selected_index >= (int)playlist->size()) {
@@ -819,37 +935,37 @@ void handleSongOperationMenuInput(int ch) {
             case 2:
                 // 添加到指定歌单
                 if (current_selected_playlist_index >= 0 && 
-                    current_selected_playlist_index < (int)ctrl.playlists.size() &&
+                    current_selected_playlist_index < (int)ctrl->playlists.size() &&
                     current_operating_song_index >= 0) {
-                    auto& playlist = ctrl.playlists[current_selected_playlist_index];
+                    auto& playlist = ctrl->playlists[current_selected_playlist_index];
                     if (current_operating_song_index < (int)playlist->size()) {
                         // 获取要添加的歌曲路径（考虑当前是否在浏览当前播放的歌单）
-                        if (current_selected_playlist_index == ctrl.currentPlaylistIndex && 
-                            ctrl.currentPlaylistIndex >= 0) {
+                        if (current_selected_playlist_index == ctrl->currentPlaylistIndex && 
+                            ctrl->currentPlaylistIndex >= 0) {
                             // 如果是当前播放的歌单，使用AppController的接口（考虑乱序模式）
-                            song_to_add_path = ctrl.getSongAt(current_operating_song_index).path;
+                            song_to_add_path = ctrl->getSongAt(current_operating_song_index).path;
                         } else {
                             // 其他歌单，直接访问
                             const auto& song = playlist->getSongs()[current_operating_song_index];
                             song_to_add_path = song.path;
                         }
                         // 进入添加到歌单界面
-                        ctrl.state = AppState::ADD_TO_PLAYLIST;
+                        ctrl->state = AppState::ADD_TO_PLAYLIST;
                         add_to_playlist_page.selected_index = 0;
-                        add_to_playlist_page.update(ctrl.playlists.size());
+                        add_to_playlist_page.update(ctrl->playlists.size());
                     }
                 }
                 break;
             case 3:
                 // 返回歌曲列表
-                ctrl.state = AppState::PLAYLIST_VIEW;
+                ctrl->state = AppState::PLAYLIST_VIEW;
                 break;
         }
     } else if (ch == 'h' || ch == 'H') {
         enterHelp();
     } else if (ch == 'q' || ch == 'Q') {
         // 返回歌曲列表
-        ctrl.state = AppState::PLAYLIST_VIEW;
+        ctrl->state = AppState::PLAYLIST_VIEW;
     }
 }
 
@@ -866,73 +982,73 @@ void handleCurrentPlaylistSongMenuInput(int ch) {
         switch (main_menu_page.selected_index) {
             case 0:
                 // 播放此歌曲
-                if (ctrl.currentPlaylistIndex >= 0 && 
-                    ctrl.currentPlaylistIndex < (int)ctrl.playlists.size() &&
+                if (ctrl->currentPlaylistIndex >= 0 && 
+                    ctrl->currentPlaylistIndex < (int)ctrl->playlists.size() &&
                     current_playlist_song_index >= 0) {
-                    auto& playlist = ctrl.playlists[ctrl.currentPlaylistIndex];
+                    auto& playlist = ctrl->playlists[ctrl->currentPlaylistIndex];
                     if (current_playlist_song_index < (int)playlist->size()) {
-                        ctrl.currentSongIndex = current_playlist_song_index;
-                        ctrl.requestLoad();
-                        ctrl.state = AppState::PLAYING;
+                        ctrl->currentSongIndex = current_playlist_song_index;
+                        ctrl->requestLoad();
+                        ctrl->state = AppState::PLAYING;
                     }
                 }
                 break;
             case 1:
                 // 从播放列表移除（从当前歌单删除）
-                if (ctrl.currentPlaylistIndex >= 0 && 
-                    ctrl.currentPlaylistIndex < (int)ctrl.playlists.size() &&
+                if (ctrl->currentPlaylistIndex >= 0 && 
+                    ctrl->currentPlaylistIndex < (int)ctrl->playlists.size() &&
                     current_playlist_song_index >= 0) {
                     // 需要将乱序索引转换为原始索引
                     int actual_index = current_playlist_song_index;
-                    if (ctrl.getPlayMode() == PlayMode::SHUFFLE && !ctrl.getShuffleOrder().empty()) {
-                        if (current_playlist_song_index >= 0 && current_playlist_song_index < (int)ctrl.getShuffleOrder().size()) {
-                            actual_index = ctrl.getShuffleOrder()[current_playlist_song_index];
+                    if (ctrl->getPlayMode() == PlayMode::SHUFFLE && !ctrl->getShuffleOrder().empty()) {
+                        if (current_playlist_song_index >= 0 && current_playlist_song_index < (int)ctrl->getShuffleOrder().size()) {
+                            actual_index = ctrl->getShuffleOrder()[current_playlist_song_index];
                         }
                     }
                     
-                    ctrl.removeSongFromPlaylist(ctrl.currentPlaylistIndex, actual_index);
+                    ctrl->removeSongFromPlaylist(ctrl->currentPlaylistIndex, actual_index);
                     
                     // 返回播放列表
-                    ctrl.state = AppState::CURRENT_PLAYLIST_VIEW;
+                    ctrl->state = AppState::CURRENT_PLAYLIST_VIEW;
                     // 更新播放列表显示
-                    auto& playlist = ctrl.playlists[ctrl.currentPlaylistIndex];
+                    auto& playlist = ctrl->playlists[ctrl->currentPlaylistIndex];
                     current_playlist_page.update(playlist->size());
                     // 重置选中索引
                     if (current_playlist_page.selected_index >= (int)playlist->size()) {
                         current_playlist_page.selected_index = std::max(0, (int)playlist->size() - 1);
                     }
                     // 更新当前歌曲索引
-                    if (ctrl.currentSongIndex >= (int)playlist->size()) {
-                        ctrl.currentSongIndex = std::max(0, (int)playlist->size() - 1);
+                    if (ctrl->currentSongIndex >= (int)playlist->size()) {
+                        ctrl->currentSongIndex = std::max(0, (int)playlist->size() - 1);
                     }
                 }
                 break;
             case 2:
                 // 添加到指定歌单
-                if (ctrl.currentPlaylistIndex >= 0 && 
-                    ctrl.currentPlaylistIndex < (int)ctrl.playlists.size() &&
+                if (ctrl->currentPlaylistIndex >= 0 && 
+                    ctrl->currentPlaylistIndex < (int)ctrl->playlists.size() &&
                     current_playlist_song_index >= 0) {
-                    auto& playlist = ctrl.playlists[ctrl.currentPlaylistIndex];
+                    auto& playlist = ctrl->playlists[ctrl->currentPlaylistIndex];
                     if (current_playlist_song_index < (int)playlist->size()) {
                         // 获取要添加的歌曲路径（考虑乱序模式）
-                        song_to_add_path = ctrl.getSongAt(current_playlist_song_index).path;
+                        song_to_add_path = ctrl->getSongAt(current_playlist_song_index).path;
                         // 进入添加到歌单界面
-                        ctrl.state = AppState::ADD_TO_PLAYLIST;
+                        ctrl->state = AppState::ADD_TO_PLAYLIST;
                         add_to_playlist_page.selected_index = 0;
-                        add_to_playlist_page.update(ctrl.playlists.size());
+                        add_to_playlist_page.update(ctrl->playlists.size());
                     }
                 }
                 break;
             case 3:
                 // 返回播放列表
-                ctrl.state = AppState::CURRENT_PLAYLIST_VIEW;
+                ctrl->state = AppState::CURRENT_PLAYLIST_VIEW;
                 break;
         }
     } else if (ch == 'h' || ch == 'H') {
         enterHelp();
     } else if (ch == 'q' || ch == 'Q') {
         // 返回播放列表
-        ctrl.state = AppState::CURRENT_PLAYLIST_VIEW;
+        ctrl->state = AppState::CURRENT_PLAYLIST_VIEW;
     }
 }
 
@@ -951,15 +1067,15 @@ void handlePlaylistEditInput(int ch) {
                 // 从目录添加歌曲
                 std::string name = inputField("输入歌单名称: ");
                 if (!name.empty()) {
-                    ctrl.createPlaylist(name);
-                    int new_index = ctrl.playlists.size() - 1;
+                    ctrl->createPlaylist(name);
+                    int new_index = ctrl->playlists.size() - 1;
                     std::string dir = inputField("输入目录路径: ");
                     if (!dir.empty()) {
-                        ctrl.addSongsFromDirectory(new_index, dir);
+                        ctrl->addSongsFromDirectory(new_index, dir);
                     }
-                    ctrl.state = AppState::PLAYLIST_MANAGER;
+                    ctrl->state = AppState::PLAYLIST_MANAGER;
                     playlist_manager_page.selected_index = new_index;
-                    playlist_manager_page.update(ctrl.playlists.size());
+                    playlist_manager_page.update(ctrl->playlists.size());
                 }
                 break;
             }
@@ -967,21 +1083,21 @@ void handlePlaylistEditInput(int ch) {
                 // 创建空歌单
                 std::string name = inputField("输入歌单名称: ");
                 if (!name.empty()) {
-                    ctrl.createPlaylist(name);
-                    ctrl.state = AppState::PLAYLIST_MANAGER;
-                    playlist_manager_page.update(ctrl.playlists.size());
+                    ctrl->createPlaylist(name);
+                    ctrl->state = AppState::PLAYLIST_MANAGER;
+                    playlist_manager_page.update(ctrl->playlists.size());
                 }
                 break;
             }
             case 2:
                 // 返回歌单管理器
-                ctrl.state = AppState::PLAYLIST_MANAGER;
+                ctrl->state = AppState::PLAYLIST_MANAGER;
                 break;
         }
     } else if (ch == 'h' || ch == 'H') {
         enterHelp();
     } else if (ch == 'q' || ch == 'Q') {
-        ctrl.state = AppState::PLAYLIST_MANAGER;
+        ctrl->state = AppState::PLAYLIST_MANAGER;
     }
 }
 
@@ -990,7 +1106,7 @@ void handleAddToPlaylistInput(int ch) {
         add_to_playlist_page.moveUp();
         // 如果选中了分隔线，继续向上移动
         int selected = add_to_playlist_page.selected_index;
-        int playlist_count = ctrl.playlists.size();
+        int playlist_count = ctrl->playlists.size();
         if (selected == playlist_count) {
             // 选中了分隔线，向上移动一位
             add_to_playlist_page.selected_index = playlist_count - 1;
@@ -999,7 +1115,7 @@ void handleAddToPlaylistInput(int ch) {
         add_to_playlist_page.moveDown();
         // 如果选中了分隔线，继续向下移动
         int selected = add_to_playlist_page.selected_index;
-        int playlist_count = ctrl.playlists.size();
+        int playlist_count = ctrl->playlists.size();
         if (selected == playlist_count) {
             // 选中了分隔线，向下移动一位
             add_to_playlist_page.selected_index = playlist_count + 1;
@@ -1010,33 +1126,33 @@ void handleAddToPlaylistInput(int ch) {
         add_to_playlist_page.nextPage();
     } else if (ch == '\n' || ch == 13) {
         int selected = add_to_playlist_page.selected_index;
-        int playlist_count = ctrl.playlists.size();
+        int playlist_count = ctrl->playlists.size();
         
         if (selected < playlist_count) {
             // 选择歌单 - 添加歌曲
             if (!song_to_add_path.empty()) {
                 // 添加指定的歌曲
-                ctrl.addSongToPlaylist(selected, song_to_add_path);
+                ctrl->addSongToPlaylist(selected, song_to_add_path);
             } else {
                 // 添加当前播放的歌曲
-                ctrl.addCurrentSongToPlaylist(selected);
+                ctrl->addCurrentSongToPlaylist(selected);
             }
             // 清空歌曲路径
             song_to_add_path = "";
             // 返回来源界面
-            if (ctrl.state == AppState::SONG_OPERATION_MENU) {
-                ctrl.state = AppState::PLAYLIST_VIEW;
+            if (ctrl->state == AppState::SONG_OPERATION_MENU) {
+                ctrl->state = AppState::PLAYLIST_VIEW;
             } else {
-                ctrl.state = AppState::PLAYING;
+                ctrl->state = AppState::PLAYING;
             }
         } else if (selected == playlist_count + 1) {
             // "返回播放"选项（跳过分隔线）
-            ctrl.state = AppState::PLAYING;
+            ctrl->state = AppState::PLAYING;
         }
     } else if (ch == 'h' || ch == 'H') {
         enterHelp();
     } else if (ch == 'q' || ch == 'Q') {
-        ctrl.state = AppState::PLAYING;
+        ctrl->state = AppState::PLAYING;
     }
 }
 
@@ -1066,17 +1182,17 @@ void handleSortMenuInput(int ch) {
             
             // 保存选择的排序方式，然后进入排序顺序菜单
             selected_sort_by = by;
-            ctrl.state = AppState::SORT_ORDER_MENU;
+            ctrl->state = AppState::SORT_ORDER_MENU;
             sort_order_page.selected_index = 0;
             sort_order_page.update(2); // 升序和降序两个选项
         } else if (selected == 5) {
             // "返回歌单功能菜单"
-            ctrl.state = AppState::PLAYLIST_MENU;
+            ctrl->state = AppState::PLAYLIST_MENU;
         }
     } else if (ch == 'h' || ch == 'H') {
         enterHelp();
     } else if (ch == 'q' || ch == 'Q') {
-        ctrl.state = AppState::PLAYLIST_VIEW;
+        ctrl->state = AppState::PLAYLIST_VIEW;
     }
 }
 
@@ -1094,20 +1210,20 @@ void handleSortOrderMenuInput(int ch) {
         
         if (selected == 0) {
             // 升序
-            ctrl.sortPlaylist(current_selected_playlist_index, selected_sort_by, SortOrder::ASCENDING);
-            ctrl.state = AppState::PLAYLIST_MENU;
+            ctrl->sortPlaylist(current_selected_playlist_index, selected_sort_by, SortOrder::ASCENDING);
+            ctrl->state = AppState::PLAYLIST_MENU;
         } else if (selected == 1) {
             // 降序
-            ctrl.sortPlaylist(current_selected_playlist_index, selected_sort_by, SortOrder::DESCENDING);
-            ctrl.state = AppState::PLAYLIST_MENU;
+            ctrl->sortPlaylist(current_selected_playlist_index, selected_sort_by, SortOrder::DESCENDING);
+            ctrl->state = AppState::PLAYLIST_MENU;
         } else if (selected == 2) {
             // 返回排序方式
-            ctrl.state = AppState::PLAYLIST_SORT;
+            ctrl->state = AppState::PLAYLIST_SORT;
         }
     } else if (ch == 'h' || ch == 'H') {
         enterHelp();
     } else if (ch == 'q' || ch == 'Q') {
-        ctrl.state = AppState::PLAYLIST_SORT;
+        ctrl->state = AppState::PLAYLIST_SORT;
     }
 }
 
@@ -1122,15 +1238,24 @@ void handleSettingsInput(int ch) {
         main_menu_page.nextPage();
     } else if (ch == '\n' || ch == 13) {
         if (main_menu_page.selected_index == 0) {
-            ctrl.state = AppState::SET_MODE;
-            main_menu_page.selected_index = (ctrl.mode == PlayMode::SEQUENTIAL ? 0 : 1);
+            ctrl->state = AppState::SET_MODE;
+            main_menu_page.selected_index = (ctrl->mode == PlayMode::SEQUENTIAL ? 0 : 1);
         } else if (main_menu_page.selected_index == 1) {
-            ctrl.state = AppState::MAIN_MENU;
+            ctrl->state = AppState::SET_CROSSFADE;
+            main_menu_page.selected_index = ctrl->getCrossfadeSeconds(); // 选中当前时长
+        } else if (main_menu_page.selected_index == 2) {
+            ctrl->state = AppState::SET_REPLAY_GAIN;
+            main_menu_page.selected_index = (int)ctrl->getReplayGainMode(); // 选中当前模式
+        } else if (main_menu_page.selected_index == 3) {
+            ctrl->state = AppState::SET_EQUALIZER;
+            main_menu_page.selected_index = 0;
+        } else if (main_menu_page.selected_index == 4) {
+            ctrl->state = AppState::MAIN_MENU;
         }
     } else if (ch == 'h' || ch == 'H') {
         enterHelp();
     } else if (ch == 'q' || ch == 'Q') {
-        ctrl.state = AppState::MAIN_MENU;
+        ctrl->state = AppState::MAIN_MENU;
     }
 }
 
@@ -1158,29 +1283,132 @@ void handlePlayModeInput(int ch) {
                 break;
             default:
                 // 返回设置
-                ctrl.state = AppState::SETTINGS_MENU;
+                ctrl->state = AppState::SETTINGS_MENU;
                 main_menu_page.selected_index = 0;
                 return;
         }
         
         // 只有当选择的模式与当前模式不同时才调用togglePlayMode
         // 由于togglePlayMode现在是循环切换，我们需要多次调用直到达到目标模式
-        while (ctrl.getPlayMode() != selected_mode) {
-            ctrl.togglePlayMode();
+        while (ctrl->getPlayMode() != selected_mode) {
+            ctrl->togglePlayMode();
         }
         
-        ctrl.state = AppState::SETTINGS_MENU;
+        ctrl->state = AppState::SETTINGS_MENU;
         main_menu_page.selected_index = 0;
     } else if (ch == 'h' || ch == 'H') {
         enterHelp();
     } else if (ch == 'q' || ch == 'Q') {
-        ctrl.state = AppState::SETTINGS_MENU;
+        ctrl->state = AppState::SETTINGS_MENU;
+    }
+}
+
+void handleCrossfadeInput(int ch) {
+    if (ch == KEY_UP) {
+        main_menu_page.moveUp();
+    } else if (ch == KEY_DOWN) {
+        main_menu_page.moveDown();
+    } else if (ch == KEY_PPAGE) {
+        main_menu_page.prevPage();
+    } else if (ch == KEY_NPAGE) {
+        main_menu_page.nextPage();
+    } else if (ch == '\n' || ch == 13) {
+        // 选项 0 为关闭，1-12 为秒数，最后一项返回设置
+        int selected = main_menu_page.selected_index;
+        if (selected >= 0 && selected <= MusicPlayer::kMaxCrossfadeSeconds) {
+            ctrl->setCrossfadeSeconds(selected);
+        }
+        ctrl->state = AppState::SETTINGS_MENU;
+        main_menu_page.selected_index = 1;
+    } else if (ch == 'h' || ch == 'H') {
+        enterHelp();
+    } else if (ch == 'q' || ch == 'Q') {
+        ctrl->state = AppState::SETTINGS_MENU;
+        main_menu_page.selected_index = 1;
+    }
+}
+
+void handleReplayGainInput(int ch) {
+    if (ch == KEY_UP) {
+        main_menu_page.moveUp();
+    } else if (ch == KEY_DOWN) {
+        main_menu_page.moveDown();
+    } else if (ch == '\n' || ch == 13) {
+        // 选项顺序与 ReplayGainMode 一致，最后一项返回设置
+        int selected = main_menu_page.selected_index;
+        if (selected >= 0 && selected <= (int)ReplayGainMode::ALBUM) {
+            ctrl->setReplayGainMode((ReplayGainMode)selected);
+        }
+        ctrl->state = AppState::SETTINGS_MENU;
+        main_menu_page.selected_index = 2;
+    } else if (ch == 'h' || ch == 'H') {
+        enterHelp();
+    } else if (ch == 'q' || ch == 'Q') {
+        ctrl->state = AppState::SETTINGS_MENU;
+        main_menu_page.selected_index = 2;
+    }
+}
+
+void handleEqualizerInput(int ch) {
+    if (ch == KEY_UP) {
+        main_menu_page.moveUp();
+    } else if (ch == KEY_DOWN) {
+        main_menu_page.moveDown();
+    } else if (ch == KEY_PPAGE) {
+        main_menu_page.prevPage();
+    } else if (ch == KEY_NPAGE) {
+        main_menu_page.nextPage();
+    } else if (ch == '\n' || ch == 13) {
+        // 选项 0 为开关，之后是各预设，最后一项返回设置
+        int selected = main_menu_page.selected_index;
+        int preset_count = (int)ctrl->getEqualizerPresets().size();
+        if (selected == 0) {
+            ctrl->setEqualizerEnabled(!ctrl->isEqualizerEnabled());
+        } else if (selected <= preset_count) {
+            // 选择预设时同时开启均衡器
+            ctrl->selectEqualizerPreset(selected - 1);
+            if (!ctrl->isEqualizerEnabled()) ctrl->setEqualizerEnabled(true);
+        } else {
+            ctrl->state = AppState::SETTINGS_MENU;
+            main_menu_page.selected_index = 3;
+        }
+    } else if (ch == 'h' || ch == 'H') {
+        enterHelp();
+    } else if (ch == 'q' || ch == 'Q') {
+        ctrl->state = AppState::SETTINGS_MENU;
+        main_menu_page.selected_index = 3;
     }
 }
 
 // --- 主函数 ---
-int main() {
+int main(int argc, char** argv) {
     setlocale(LC_ALL, "");
+    
+    // smp --benchmark-gain：比较各增益内核的耗时后退出
+    if (argc > 1 && std::string(argv[1]) == "--benchmark-gain") {
+        GainStage::benchmark(std::cout);
+        return 0;
+    }
+    // smp --benchmark-lyrics：测试歌词解析速度后退出
+    if (argc > 1 && std::string(argv[1]) == "--benchmark-lyrics") {
+        LyricParser::benchmark(std::cout);
+        return 0;
+    }
+    // smp --convert-playlist <输入> <输出>：在 .json 与 .smpl 歌单之间转换
+    if (argc > 3 && std::string(argv[1]) == "--convert-playlist") {
+        if (PlaylistFile::convert(argv[2], argv[3])) return 0;
+        std::cerr << "无法转换歌单: " << argv[2] << std::endl;
+        return 1;
+    }
+    // smp --benchmark-playlist：比较歌单两种存储格式的加载速度后退出
+    // （各项在 fork 出的子进程中测量，此时进程中不能有其他线程）
+    if (argc > 1 && std::string(argv[1]) == "--benchmark-playlist") {
+        PlaylistFile::benchmark(std::cout);
+        return 0;
+    }
+    
+    ctrl = std::make_unique<AppController>();
+    
     initscr();
     cbreak();
     noecho();
@@ -1203,20 +1431,20 @@ int main() {
     sort_menu_page.items_per_page = 10;
     sort_order_page.items_per_page = 10;
 
-    while (ctrl.isRunning()) {
+    while (ctrl->isRunning()) {
         // 处理输入
         int ch = getch();
         if (ch != ERR) {
             // 特殊处理播放界面的 Q 键
             if (ch == 'q' || ch == 'Q') {
-                if (ctrl.state == AppState::PLAYING) {
-                    ctrl.stop();
+                if (ctrl->state == AppState::PLAYING) {
+                    ctrl->stop();
                     break;
                 }
             }
             
             // 其他按键处理
-            switch (ctrl.state) {
+            switch (ctrl->state) {
                 case AppState::PLAYING:
                     handlePlayingInput(ch);
                     break;
@@ -1259,19 +1487,31 @@ int main() {
                 case AppState::SET_MODE:
                     handlePlayModeInput(ch);
                     break;
+                case AppState::SET_CROSSFADE:
+                    handleCrossfadeInput(ch);
+                    break;
+                case AppState::SET_REPLAY_GAIN:
+                    handleReplayGainInput(ch);
+                    break;
+                case AppState::SET_EQUALIZER:
+                    handleEqualizerInput(ch);
+                    break;
                 case AppState::HELP:
-                    ctrl.state = previous_state;
+                    ctrl->state = previous_state;
                     break;
                 default:
                     break;
             }
         }
 
+        // 只有播放界面显示时才让音频回调复制样本
+        ctrl->getPlayer().getAudioTap().setActive(ctrl->state == AppState::PLAYING);
+        
         // 渲染界面
         erase();
         {
-            std::lock_guard<std::mutex> lock(ctrl.getMutex());
-            switch (ctrl.state) {
+            std::lock_guard<std::mutex> lock(ctrl->getMutex());
+            switch (ctrl->state) {
                 case AppState::PLAYING:
                     renderPlaying();
                     break;
@@ -1314,6 +1554,15 @@ int main() {
                 case AppState::SET_MODE:
                     renderPlayMode();
                     break;
+                case AppState::SET_CROSSFADE:
+                    renderCrossfade();
+                    break;
+                case AppState::SET_REPLAY_GAIN:
+                    renderReplayGain();
+                    break;
+                case AppState::SET_EQUALIZER:
+                    renderEqualizer();
+                    break;
                 case AppState::HELP:
                     switch (previous_state) {
                         case AppState::PLAYING:
@@ -1358,6 +1607,15 @@ int main() {
                         case AppState::SET_MODE:
                             drawHelp(PLAY_MODE_HELP);
                             break;
+                        case AppState::SET_CROSSFADE:
+                            drawHelp(CROSSFADE_HELP);
+                            break;
+                        case AppState::SET_REPLAY_GAIN:
+                            drawHelp(REPLAY_GAIN_HELP);
+                            break;
+                        case AppState::SET_EQUALIZER:
+                            drawHelp(EQUALIZER_HELP);
+                            break;
                         default:
                             drawHelp(MAIN_MENU_HELP);
                             break;